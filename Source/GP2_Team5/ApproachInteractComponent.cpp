@@ -4,6 +4,7 @@
 #include "ApproachInteractComponent.h"
 #include "Blueprint/UserWidget.h"
 #include "Components/WidgetComponent.h"
+#include "InteractionTrace.h"
 
 // Sets default values for this component's properties
 UApproachInteractComponent::UApproachInteractComponent()
@@ -32,13 +33,13 @@ void UApproachInteractComponent::TickComponent(float DeltaTime, ELevelTick TickT
 
 void UApproachInteractComponent::Interact_Implementation()
 {
-	UE_LOG(LogTemp, Warning, TEXT("%s: Interact()"), *GetName());
+	UE_LOG(LogInteraction, Verbose, TEXT("%s: Interact()"), *GetName());
 	OnInteract.Broadcast();
 }
 
 void UApproachInteractComponent::InteractReleased_Implementation()
 {
-	UE_LOG(LogTemp, Warning, TEXT("%s: InteractReleased()"), *GetName());
+	UE_LOG(LogInteraction, Verbose, TEXT("%s: InteractReleased()"), *GetName());
 	OnInteractReleased.Broadcast();
 }
 
@@ -55,7 +56,7 @@ void UApproachInteractComponent::ShowInteractionWidget()
 	if (bShowInteractWidget == false) { return; }
 	if (WidgetComp == nullptr) { return; }
 
-	UE_LOG(LogTemp, Warning, TEXT("%s: ShowInteractionWidget()"), *GetName());
+	INTERACTION_TRACE(ShowInteractionWidget, None, GetOwner(), this);
 	WidgetComp->SetVisibility(true);
 }
 
@@ -64,6 +65,6 @@ void UApproachInteractComponent::HideInteractionWidget()
 	if (bShowInteractWidget == false) { return; }
 	if (WidgetComp == nullptr) { return; }
 
-	UE_LOG(LogTemp, Warning, TEXT("%s: HideInteractionWidget()"), *GetName());
+	INTERACTION_TRACE(HideInteractionWidget, None, GetOwner(), this);
 	WidgetComp->SetVisibility(false);
 }
@@ -16,7 +16,7 @@ void ICheckPointInterface::OnEnterCheckPoint_Implementation(AActor* Caller)
 }
 
 
-void ICheckPointInterface::OnFinnishLevel_Implementation()
+void ICheckPointInterface::OnFinnishlevel_Implementation()
 {
 
 }
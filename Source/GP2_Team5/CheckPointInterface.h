@@ -33,5 +33,5 @@ public:
 
 	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "C++ Interaction")
 	void OnFinnishlevel();
-	virtual void OnFinnishLevel_Implementation();
+	virtual void OnFinnishlevel_Implementation();
 };
@@ -2,26 +2,48 @@
 
 
 #include "Checkpoint.h"
+#include "Components/BoxComponent.h"
+#include "GravityCharacter.h"
+#include "CheckpointSubsystem.h"
 
 // Sets default values
 ACheckpoint::ACheckpoint()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
-
+	PrimaryActorTick.bCanEverTick = false;
 }
 
 // Called when the game starts or when spawned
 void ACheckpoint::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	if (bEnterOnOverlap == false) { return; }
+
+	UBoxComponent* Trigger = FindComponentByClass<UBoxComponent>();
+	if (Trigger == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s enters on overlap but has no box component"), *GetName());
+		return;
+	}
+	Trigger->OnComponentBeginOverlap.AddDynamic(this, &ACheckpoint::OnTriggerBeginOverlap);
 }
 
-// Called every frame
-void ACheckpoint::Tick(float DeltaTime)
+FName ACheckpoint::GetCheckpointId() const
 {
-	Super::Tick(DeltaTime);
+	return CheckpointId.IsNone() ? GetFName() : CheckpointId;
+}
 
+FVector ACheckpoint::GetRespawnLocation() const
+{
+	return GetActorTransform().TransformPosition(RespawnOffset);
 }
 
+void ACheckpoint::OnTriggerBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+{
+	if (Cast<AGravityCharacter>(OtherActor) == nullptr) { return; }
+
+	if (UCheckpointSubsystem* Checkpoints = UCheckpointSubsystem::Get(this))
+	{
+		Checkpoints->EnterCheckpoint(this);
+	}
+}
@@ -6,6 +6,11 @@
 #include "GameFramework/Actor.h"
 #include "Checkpoint.generated.h"
 
+/**
+ * Hands the player's arrival to UCheckpointSubsystem, which records the world state to respawn into.
+ * Has no volume of its own, Blueprints bring theirs: either call UCheckpointSubsystem::EnterCheckpoint from their
+ * own overlap, or set bEnterOnOverlap to have the actor's box component do it.
+ */
 UCLASS()
 class GP2_TEAM5_API ACheckpoint : public AActor
 {
@@ -15,12 +20,35 @@ public:
 	// Sets default values for this actor's properties
 	ACheckpoint();
 
+	UFUNCTION(BlueprintPure, Category = "Checkpoint")
+	FName GetCheckpointId() const;
+
+	UFUNCTION(BlueprintPure, Category = "Checkpoint")
+	FVector GetRespawnLocation() const;
+
+	bool ShouldAutosave() const { return bAutosave; }
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+	UFUNCTION()
+	void OnTriggerBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor,
+		UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+
+	/* Enter the checkpoint when the player overlaps the actor's box component */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Checkpoint")
+	bool bEnterOnOverlap = false;
+
+	/* Where the player comes back after dying, relative to the actor */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Checkpoint", meta = (MakeEditWidget = true))
+	FVector RespawnOffset = FVector::ZeroVector;
+
+	/* Stored in the save game. The actor name when left empty */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Checkpoint")
+	FName CheckpointId;
 
+	/* Write the player's progress to disk when this checkpoint is reached */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Checkpoint")
+	bool bAutosave = true;
 };
@@ -0,0 +1,209 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CheckpointSubsystem.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Kismet/GameplayStatics.h"
+#include "GameFramework/GameModeBase.h"
+#include "Checkpoint.h"
+#include "CheckPointInterface.h"
+#include "Collectible.h"
+#include "CollectibleField.h"
+#include "GravityCharacter.h"
+#include "GravityMovementComponent.h"
+#include "SaveGameSubsystem.h"
+
+void UCheckpointSubsystem::Deinitialize()
+{
+	for (ACollectible* Collectible : Collectibles)
+	{
+		Collectible->CheckpointIndex = INDEX_NONE;
+	}
+	Collectibles.Reset();
+	CollectedAtCheckpoint.Empty();
+	Fields.Reset();
+	PuzzleActors.Reset();
+
+	Super::Deinitialize();
+}
+
+UCheckpointSubsystem* UCheckpointSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject != nullptr ? WorldContextObject->GetWorld() : nullptr;
+	if (World == nullptr || World->IsGameWorld() == false) { return nullptr; }
+
+	return World->GetSubsystem<UCheckpointSubsystem>();
+}
+
+void UCheckpointSubsystem::RegisterCollectible(ACollectible* Collectible)
+{
+	if (Collectible == nullptr || Collectible->CheckpointIndex != INDEX_NONE) { return; }
+
+	Collectible->CheckpointIndex = Collectibles.Add(Collectible);
+	CollectedAtCheckpoint.Add(Collectible->IsCollected());
+}
+
+void UCheckpointSubsystem::UnregisterCollectible(ACollectible* Collectible)
+{
+	if (Collectible == nullptr || Collectibles.IsValidIndex(Collectible->CheckpointIndex) == false) { return; }
+
+	const int32 Index = Collectible->CheckpointIndex;
+	const int32 LastIndex = Collectibles.Num() - 1;
+	Collectible->CheckpointIndex = INDEX_NONE;
+
+	// The last entry moves into the freed slot
+	CollectedAtCheckpoint[Index] = static_cast<bool>(CollectedAtCheckpoint[LastIndex]);
+	CollectedAtCheckpoint.RemoveAt(LastIndex);
+	Collectibles.RemoveAtSwap(Index, 1, false);
+	if (Collectibles.IsValidIndex(Index))
+	{
+		Collectibles[Index]->CheckpointIndex = Index;
+	}
+}
+
+void UCheckpointSubsystem::RegisterField(ACollectibleField* Field)
+{
+	if (Field != nullptr)
+	{
+		Fields.AddUnique(Field);
+	}
+}
+
+void UCheckpointSubsystem::UnregisterField(ACollectibleField* Field)
+{
+	Fields.RemoveSwap(Field);
+}
+
+void UCheckpointSubsystem::EnterCheckpoint(ACheckpoint* Checkpoint)
+{
+	if (Checkpoint == nullptr || Checkpoint == CurrentCheckpoint.Get()) { return; }
+
+	UGravitySnapshotSubsystem* Snapshots = UGravitySnapshotSubsystem::Get(this);
+	AGravityCharacter* Player = Cast<AGravityCharacter>(UGameplayStatics::GetPlayerPawn(this, 0));
+	if (Snapshots == nullptr || Player == nullptr) { return; }
+
+	CurrentCheckpoint = Checkpoint;
+	Snapshot = Snapshots->CaptureSnapshot();
+
+	for (int32 i = 0; i < Collectibles.Num(); i++)
+	{
+		CollectedAtCheckpoint[i] = Collectibles[i]->IsCollected();
+	}
+	for (ACollectibleField* Field : Fields)
+	{
+		Field->RecordCheckpoint();
+	}
+	PlayerCollectibles = Player->Collectibles;
+	bPlayerHadRelic1 = Player->bHasRelic1;
+	bPlayerHadRelic2 = Player->bHasRelic2;
+
+	GatherPuzzleActors();
+	for (const TWeakObjectPtr<AActor>& PuzzleActor : PuzzleActors)
+	{
+		if (AActor* Actor = PuzzleActor.Get())
+		{
+			ICheckPointInterface::Execute_OnEnterCheckPoint(Actor, Checkpoint);
+		}
+	}
+
+	if (Checkpoint->ShouldAutosave())
+	{
+		if (USaveGameSubsystem* Saves = USaveGameSubsystem::Get(this))
+		{
+			Saves->SaveProgress(Checkpoint->GetCheckpointId());
+		}
+	}
+
+	OnCheckpointReached.Broadcast(Checkpoint);
+}
+
+bool UCheckpointSubsystem::Respawn()
+{
+	ACheckpoint* Checkpoint = CurrentCheckpoint.Get();
+	UGravitySnapshotSubsystem* Snapshots = UGravitySnapshotSubsystem::Get(this);
+	AGravityCharacter* Player = Cast<AGravityCharacter>(UGameplayStatics::GetPlayerPawn(this, 0));
+	if (Checkpoint == nullptr || Snapshots == nullptr || Player == nullptr || Snapshot.IsValid() == false) { return false; }
+
+	// Bodies, flips and the player's gravity, then the player goes to the respawn point at rest
+	Snapshots->RestoreSnapshot(Snapshot);
+	Player->SetActorLocation(Checkpoint->GetRespawnLocation(), false, nullptr, ETeleportType::ResetPhysics);
+	if (UGravityMovementComponent* Movement = Player->CachedGravityMovementyCmp)
+	{
+		Movement->StopMovementImmediately();
+	}
+
+	for (int32 i = 0; i < Collectibles.Num(); i++)
+	{
+		Collectibles[i]->SetCollected(CollectedAtCheckpoint[i]);
+	}
+	for (ACollectibleField* Field : Fields)
+	{
+		Field->RestoreCheckpoint();
+	}
+
+	// Written entry by entry so the player's map keeps its allocation
+	for (TPair<ECollectibleType, int32>& Collectible : Player->Collectibles)
+	{
+		const int32* Count = PlayerCollectibles.Find(Collectible.Key);
+		Collectible.Value = Count != nullptr ? *Count : 0;
+		Player->OnCollectibleAdded(Collectible.Key, Collectible.Value);
+	}
+	Player->bHasRelic1 = bPlayerHadRelic1;
+	Player->bHasRelic2 = bPlayerHadRelic2;
+
+	for (const TWeakObjectPtr<AActor>& PuzzleActor : PuzzleActors)
+	{
+		if (AActor* Actor = PuzzleActor.Get())
+		{
+			ICheckPointInterface::Execute_OnRest(Actor);
+		}
+	}
+
+	OnRespawned.Broadcast(Checkpoint);
+	return true;
+}
+
+bool UCheckpointSubsystem::RespawnAtPlayerStart()
+{
+	AGravityCharacter* Player = Cast<AGravityCharacter>(UGameplayStatics::GetPlayerPawn(this, 0));
+	AGameModeBase* GameMode = GetWorld()->GetAuthGameMode();
+	if (Player == nullptr || Player->GetController() == nullptr || GameMode == nullptr) { return false; }
+
+	AActor* PlayerStart = GameMode->FindPlayerStart(Player->GetController());
+	if (PlayerStart == nullptr) { return false; }
+
+	Player->SetActorLocation(PlayerStart->GetActorLocation(), false, nullptr, ETeleportType::ResetPhysics);
+	if (UGravityMovementComponent* Movement = Player->CachedGravityMovementyCmp)
+	{
+		Movement->StopMovementImmediately();
+	}
+
+	OnRespawned.Broadcast(nullptr);
+	return true;
+}
+
+void UCheckpointSubsystem::FinishLevel()
+{
+	GatherPuzzleActors();
+	for (const TWeakObjectPtr<AActor>& PuzzleActor : PuzzleActors)
+	{
+		if (AActor* Actor = PuzzleActor.Get())
+		{
+			ICheckPointInterface::Execute_OnFinnishlevel(Actor);
+		}
+	}
+}
+
+void UCheckpointSubsystem::GatherPuzzleActors()
+{
+	// Only when a checkpoint is reached, which is rare enough to look at every actor
+	PuzzleActors.Reset();
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	{
+		if (It->GetClass()->ImplementsInterface(UCheckPointInterface::StaticClass()))
+		{
+			PuzzleActors.Add(*It);
+		}
+	}
+}
@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Enums.h"
+#include "GravitySnapshotSubsystem.h"
+#include "CheckpointSubsystem.generated.h"
+
+//--- forward declarations ---
+class ACheckpoint;
+class ACollectible;
+class ACollectibleField;
+
+/**
+ * Records the world when the player reaches a checkpoint and puts it back in place when the player dies,
+ * instead of reloading the level. A record holds a UGravitySnapshotSubsystem snapshot of the player and every
+ * swappable body, which pickups and collectible field coins were collected, and the player's collectibles and relics.
+ * Puzzle actors implementing ICheckPointInterface keep their own state: OnEnterCheckPoint when the world is recorded,
+ * OnRest when it is restored.
+ * Respawning only writes back into memory that the record already holds.
+ */
+UCLASS()
+class GP2_TEAM5_API UCheckpointSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	static UCheckpointSubsystem* Get(const UObject* WorldContextObject);
+
+	void RegisterCollectible(ACollectible* Collectible);
+	void UnregisterCollectible(ACollectible* Collectible);
+
+	void RegisterField(ACollectibleField* Field);
+	void UnregisterField(ACollectibleField* Field);
+
+	const TArray<ACollectible*>& GetCollectibles() const { return Collectibles; }
+	const TArray<ACollectibleField*>& GetFields() const { return Fields; }
+
+	// Records the world for the player to come back to. Entering the current checkpoint again does nothing
+	UFUNCTION(BlueprintCallable, Category = "Checkpoint")
+	void EnterCheckpoint(ACheckpoint* Checkpoint);
+
+	// Puts the world back the way it was at the current checkpoint and moves the player there.
+	// Returns false when no checkpoint was reached yet
+	UFUNCTION(BlueprintCallable, Category = "Checkpoint")
+	bool Respawn();
+
+	// Moves the player back to the level's player start, before any checkpoint was reached. The world is left as it is.
+	// Broadcasts OnRespawned without a checkpoint. Returns false when there is no player or player start
+	UFUNCTION(BlueprintCallable, Category = "Checkpoint")
+	bool RespawnAtPlayerStart();
+
+	// Tells the puzzle actors the level is done
+	UFUNCTION(BlueprintCallable, Category = "Checkpoint")
+	void FinishLevel();
+
+	UFUNCTION(BlueprintPure, Category = "Checkpoint")
+	ACheckpoint* GetCurrentCheckpoint() const { return CurrentCheckpoint.Get(); }
+
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnCheckpointEvent, ACheckpoint*, Checkpoint);
+
+	UPROPERTY(BlueprintAssignable, Category = "Checkpoint")
+	FOnCheckpointEvent OnCheckpointReached;
+
+	UPROPERTY(BlueprintAssignable, Category = "Checkpoint")
+	FOnCheckpointEvent OnRespawned;
+
+protected:
+	// Every actor in the world implementing ICheckPointInterface
+	void GatherPuzzleActors();
+
+	TWeakObjectPtr<ACheckpoint> CurrentCheckpoint;
+	FGravitySnapshot Snapshot;
+
+	TArray<ACollectible*> Collectibles;
+	// Same index as Collectibles, whether it was collected when the checkpoint was reached
+	TBitArray<> CollectedAtCheckpoint;
+
+	// Keep which of their coins were collected themselves
+	TArray<ACollectibleField*> Fields;
+
+	TMap<ECollectibleType, int32> PlayerCollectibles;
+	bool bPlayerHadRelic1 = false;
+	bool bPlayerHadRelic2 = false;
+
+	TArray<TWeakObjectPtr<AActor>> PuzzleActors;
+};
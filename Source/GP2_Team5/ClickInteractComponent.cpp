@@ -5,6 +5,7 @@
 #include "Kismet/GameplayStatics.h"
 #include "GravityCharacter.h"
 #include "Enums.h"
+#include "InteractionTrace.h"
 
 // Sets default values for this component's properties
 UClickInteractComponent::UClickInteractComponent()
@@ -28,18 +29,18 @@ void UClickInteractComponent::BeginPlay()
 	UMeshComponent* Mesh = GetMeshComponent<USkeletalMeshComponent>(GetOwner());
 	if (Mesh == nullptr)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Couldn't Find SkeletalMeshComp. Trying to get StaticMeshComp..."));
+		UE_LOG(LogInteraction, Verbose, TEXT("Couldn't Find SkeletalMeshComp. Trying to get StaticMeshComp..."));
 		Mesh = GetMeshComponent<UStaticMeshComponent>(GetOwner());
 		if (Mesh == nullptr)
 		{
-			UE_LOG(LogTemp, Warning, TEXT("Couldn't Find StaticMeshComp either..."));
+			UE_LOG(LogInteraction, Warning, TEXT("%s: Couldn't Find StaticMeshComp either..."), *GetOwner()->GetName());
 			return;
 		}
 	}
 
 	if (Mesh != nullptr)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Found Mesh! Owner: %s, Mesh: %s"), *GetOwner()->GetName(), *Mesh->GetName());
+		UE_LOG(LogInteraction, Verbose, TEXT("Found Mesh! Owner: %s, Mesh: %s"), *GetOwner()->GetName(), *Mesh->GetName());
 		Mesh->OnBeginCursorOver.AddUniqueDynamic(this, &UClickInteractComponent::ActivateHighlight);
 		Mesh->OnEndCursorOver.AddUniqueDynamic(this, &UClickInteractComponent::DeactivateHighlight);
 	}
@@ -58,47 +59,24 @@ bool UClickInteractComponent::Clickable()
 {
 	AGravityCharacter* Player = GetGravityCharacter();
 
-	// has no ability to swap gravity between player + obj 
-	if (!Player->HasRelic1())
-	{
-		if (Player->GetClickFocusType(Player->GetCurrentClickFocus()) == EFocusType::Player && Player->GetClickFocusType(this) == EFocusType::Object
-			|| Player->GetClickFocusType(Player->GetCurrentClickFocus()) == EFocusType::Object && Player->GetClickFocusType(this) == EFocusType::Player)
-		{
-			UE_LOG(LogTemp, Warning, TEXT("Player doesn't have Relic1"));
-			return false;
-		}
-	}
-
-	// has no ability to swap gravity between obj + obj 
-	if (!Player->HasRelic2())
-	{
-		if (Player->GetClickFocusType(Player->GetCurrentClickFocus()) == EFocusType::Object && Player->GetClickFocusType(this) == EFocusType::Object)
-		{
-			UE_LOG(LogTemp, Warning, TEXT("Player doesn't have Relic2"));
-			return false;
-		}
-	}
-
-	// if this component CANNOT swap gravity with player's current focus
+	// if this component CANNOT swap gravity with player's current focus.
+	// Relic rules, range and line of sight were already resolved by the player's swap partner solver
 	if (Player->GetCurrentClickFocus() != nullptr)
 	{
-		if (Player->CanSwapGravity(this, Player->GetCurrentClickFocus()) == false)
-		{
-			return false;
-		}
+		return Player->GetSwapPartners().IsPartner(this);
 	}
 
 	// this component is not in player's line of sight
 	if (Player->IsComponentInLineOfSight(this) == false)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("This actor ( %s ) is not in player's line of sight"), *GetOwner()->GetName());
+		INTERACTION_TRACE(Clickable, NotInLineOfSight, Player, this);
 		return false;
 	}
 
 	// This component is not within player's interact range
 	if (Player->GetDistanceTo(GetOwner()) > Player->GetClickInteractRange())
 	{
-		UE_LOG(LogTemp, Warning, TEXT("This actor ( %s ) is not within Player's interaction range"), *GetOwner()->GetName());
+		INTERACTION_TRACE(Clickable, OutOfRange, Player, this);
 		return false;
 	}
 
@@ -122,6 +100,13 @@ void UClickInteractComponent::OnReset()
 void UClickInteractComponent::ActivateHighlight(UPrimitiveComponent* TouchedComponent)
 {
 	AGravityCharacter* Player = GetGravityCharacter();
+
+	// Hovering a swap partner shows where both bodies would go
+	if (Player != nullptr && Player->GetCurrentClickFocus() != nullptr && Player->GetSwapPartners().IsPartner(this))
+	{
+		Player->PreviewSwapWith(this);
+	}
+
 	if (Player == nullptr || (!Player->HasRelic1() && !Player->HasRelic2()) || bSelected || bIsSwappableColorOn)
 	{
 		return;
@@ -148,6 +133,12 @@ void UClickInteractComponent::SwappableHighlight()
 void UClickInteractComponent::DeactivateHighlight(UPrimitiveComponent* TouchedComponent)
 {
 	AGravityCharacter* Player = GetGravityCharacter();
+
+	if (Player != nullptr && Player->GetSwapPartners().IsPartner(this))
+	{
+		Player->ClearSwapPreview();
+	}
+
 	if (Player == nullptr || (!Player->HasRelic1() && !Player->HasRelic2()) || bSelected || bIsSwappableColorOn)
 	{
 		return;
@@ -6,6 +6,8 @@
 #include "Components/SphereComponent.h"
 #include "GravityCharacter.h"
 #include "Components/StaticMeshComponent.h"
+#include "InteractionTrace.h"
+#include "CheckpointSubsystem.h"
 
 // Sets default values
 ACollectible::ACollectible()
@@ -28,6 +30,31 @@ void ACollectible::BeginPlay()
 	Super::BeginPlay();
 
 	SphereCollision->OnComponentBeginOverlap.AddDynamic(this, &ACollectible::OnComponentBeginOverlap);
+
+	if (UCheckpointSubsystem* Checkpoints = UCheckpointSubsystem::Get(this))
+	{
+		Checkpoints->RegisterCollectible(this);
+	}
+}
+
+void ACollectible::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UCheckpointSubsystem* Checkpoints = UCheckpointSubsystem::Get(this))
+	{
+		Checkpoints->UnregisterCollectible(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ACollectible::SetCollected(bool bNewCollected)
+{
+	if (bCollected == bNewCollected) { return; }
+
+	bCollected = bNewCollected;
+	SetActorHiddenInGame(bCollected);
+	SetActorEnableCollision(bCollected == false);
+	RotatingMovementCmp->SetComponentTickEnabled(bCollected == false);
 }
 
 // Called every frame
@@ -39,12 +66,19 @@ void ACollectible::Tick(float DeltaTime)
 										   
 void ACollectible::OnComponentBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
-	UE_LOG(LogTemp, Warning, L"picked up coin");
+	if (bCollected) { return; }
+
 	if (OtherActor->GetClass()->IsChildOf(AGravityCharacter::StaticClass()))
 	{
+		INTERACTION_TRACE(CollectibleOverlap, Accepted, this, OtherActor);
 		AGravityCharacter* Player = Cast<AGravityCharacter>(OtherActor);
 		Player->AddCollectible(this);
+		SetCollected(true);
 		OnPickedUp(Player);
 	}
+	else
+	{
+		INTERACTION_TRACE(CollectibleOverlap, NotPlayer, this, OtherActor);
+	}
 }
 
@@ -17,11 +17,18 @@ public:
 	// Sets default values for this actor's properties
 	ACollectible();
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void Tick(float DeltaTime);
 
 	ECollectibleType GetType() const { return Type; }
 	int32 GetCount() const { return Count; }
 
+	// A collected pickup is hidden rather than destroyed, so a respawn can bring it back
+	UFUNCTION(BlueprintPure, Category = "Collectible")
+	bool IsCollected() const { return bCollected; }
+
+	void SetCollected(bool bNewCollected);
+
 	UFUNCTION(BlueprintImplementableEvent, Category ="Collectible")
 	void OnPickedUp(class AGravityCharacter* PickedBy);
 
@@ -30,7 +37,8 @@ public:
 		UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
 
 protected:
-	
+	friend class UCheckpointSubsystem;
+
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Collectible")
 	ECollectibleType Type = ECollectibleType::Coin;
 
@@ -47,4 +55,8 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Collectible")
 	class UStaticMeshComponent* Mesh = nullptr;
 
+	bool bCollected = false;
+
+	// Slot in UCheckpointSubsystem
+	int32 CheckpointIndex = INDEX_NONE;
 };
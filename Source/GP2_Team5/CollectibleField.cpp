@@ -0,0 +1,270 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CollectibleField.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Materials/MaterialInterface.h"
+#include "Kismet/GameplayStatics.h"
+#include "GravityCharacter.h"
+#include "CheckpointSubsystem.h"
+#include "InteractionTrace.h"
+
+ACollectibleField::ACollectibleField()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	Coins = CreateDefaultSubobject<UHierarchicalInstancedStaticMeshComponent>(TEXT("Coins"));
+	Coins->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Coins->SetGenerateOverlapEvents(false);
+	// Collected coins are hidden at runtime
+	Coins->SetMobility(EComponentMobility::Movable);
+	RootComponent = Coins;
+}
+
+void ACollectibleField::BeginPlay()
+{
+	Super::BeginPlay();
+
+	const int32 NumCoins = Coins->GetInstanceCount();
+	CoinTransforms.SetNumUninitialized(NumCoins);
+	for (int32 i = 0; i < NumCoins; i++)
+	{
+		Coins->GetInstanceTransform(i, CoinTransforms[i], false);
+	}
+	Collected.Init(false, NumCoins);
+	CollectedAtCheckpoint.Init(false, NumCoins);
+	UpdateCoinLocations();
+
+	// Coins is movable so collected coins can be hidden, and may be carried around by whatever it is attached to
+	Coins->TransformUpdated.AddUObject(this, &ACollectibleField::OnCoinsMoved);
+
+	if (SpinMaterial != nullptr)
+	{
+		Coins->SetMaterial(0, SpinMaterial);
+	}
+	else
+	{
+		SpinTransforms = CoinTransforms;
+	}
+
+	if (UCheckpointSubsystem* Checkpoints = UCheckpointSubsystem::Get(this))
+	{
+		Checkpoints->RegisterField(this);
+	}
+
+	// Picks up along the path the player moved this frame
+	AddTickPrerequisiteActor(UGameplayStatics::GetPlayerPawn(this, 0));
+}
+
+void ACollectibleField::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Coins->TransformUpdated.RemoveAll(this);
+
+	if (UCheckpointSubsystem* Checkpoints = UCheckpointSubsystem::Get(this))
+	{
+		Checkpoints->UnregisterField(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ACollectibleField::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	AGravityCharacter* Player = Cast<AGravityCharacter>(UGameplayStatics::GetPlayerPawn(this, 0));
+	if (Player != nullptr && NumCollected < CoinTransforms.Num())
+	{
+		const FVector PlayerLocation = Player->GetActorLocation();
+		PickUpAlong(Player, bHasLastPlayerLocation ? LastPlayerLocation : PlayerLocation, PlayerLocation);
+		LastPlayerLocation = PlayerLocation;
+		bHasLastPlayerLocation = true;
+	}
+
+	if (SpinMaterial == nullptr)
+	{
+		UpdateSpin(DeltaTime);
+	}
+}
+
+void ACollectibleField::OnCoinsMoved(USceneComponent* Component, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	UpdateCoinLocations();
+}
+
+void ACollectibleField::UpdateCoinLocations()
+{
+	const FTransform& ComponentTransform = Coins->GetComponentTransform();
+	CoinLocations.SetNumUninitialized(CoinTransforms.Num());
+	for (int32 i = 0; i < CoinTransforms.Num(); i++)
+	{
+		CoinLocations[i] = ComponentTransform.TransformPosition(CoinTransforms[i].GetLocation());
+	}
+	BuildHash();
+}
+
+void ACollectibleField::BuildHash()
+{
+	Cells.Reset();
+	CellCoins.Reset();
+	CoinBounds.Init();
+
+	// Count per cell, then hand out ranges and fill them, so every cell's coins sit next to each other
+	for (const FVector& Location : CoinLocations)
+	{
+		Cells.FindOrAdd(GetCell(Location)).Num++;
+		CoinBounds += Location;
+	}
+	int32 Start = 0;
+	for (TPair<FIntVector, FCoinCell>& Cell : Cells)
+	{
+		Cell.Value.Start = Start;
+		Start += Cell.Value.Num;
+		Cell.Value.Num = 0;
+	}
+	CellCoins.SetNumUninitialized(Start);
+	for (int32 i = 0; i < CoinLocations.Num(); i++)
+	{
+		FCoinCell& Cell = Cells.FindChecked(GetCell(CoinLocations[i]));
+		CellCoins[Cell.Start + Cell.Num++] = i;
+	}
+	CoinBounds = CoinBounds.ExpandBy(PickupRadius);
+}
+
+FIntVector ACollectibleField::GetCell(const FVector& Location) const
+{
+	const float CellSize = FMath::Max(2.f * PickupRadius, 1.f);
+	return FIntVector(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize), FMath::FloorToInt(Location.Z / CellSize));
+}
+
+void ACollectibleField::PickUpAlong(AGravityCharacter* Player, const FVector& Start, const FVector& End)
+{
+	// A jump this long is a teleport rather than a path, only where it ends picks anything up
+	const FVector From = FVector::DistSquared(Start, End) > FMath::Square(MaxSweepDistance) ? End : Start;
+
+	FBox Swept(ForceInit);
+	Swept += From;
+	Swept += End;
+	Swept = Swept.ExpandBy(PickupRadius);
+	if (Swept.Intersect(CoinBounds) == false) { return; }
+
+	const float RadiusSquared = FMath::Square(PickupRadius);
+	const FIntVector MinCell = GetCell(Swept.Min);
+	const FIntVector MaxCell = GetCell(Swept.Max);
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; Z++)
+			{
+				const FCoinCell* Cell = Cells.Find(FIntVector(X, Y, Z));
+				if (Cell == nullptr) { continue; }
+
+				for (int32 i = Cell->Start; i < Cell->Start + Cell->Num; i++)
+				{
+					const int32 Index = CellCoins[i];
+					if (Collected[Index]) { continue; }
+					if (FMath::PointDistToSegmentSquared(CoinLocations[Index], From, End) > RadiusSquared) { continue; }
+
+					INTERACTION_TRACE(CollectibleOverlap, Accepted, this, Player);
+					SetCoinCollected(Index, true);
+					Player->AddCollectibles(Type, CountPerCoin);
+					OnCoinPickedUp(Player, CoinLocations[Index]);
+				}
+			}
+		}
+	}
+}
+
+void ACollectibleField::SetCoinCollected(int32 Index, bool bNewCollected)
+{
+	if (Collected[Index] == bNewCollected) { return; }
+
+	Collected[Index] = bNewCollected;
+	NumCollected += bNewCollected ? 1 : -1;
+	Coins->UpdateInstanceTransform(Index, GetCoinTransform(Index), false, true, true);
+}
+
+FTransform ACollectibleField::GetCoinTransform(int32 Index) const
+{
+	if (Collected[Index])
+	{
+		return FTransform(FQuat::Identity, CoinTransforms[Index].GetLocation(), FVector::ZeroVector);
+	}
+	return SpinMaterial != nullptr ? CoinTransforms[Index] : SpinTransforms[Index];
+}
+
+void ACollectibleField::UpdateSpin(float DeltaTime)
+{
+	if (CoinTransforms.Num() == 0 || WasRecentlyRendered() == false) { return; }
+
+	SpinAngle = FMath::Fmod(SpinAngle + FMath::DegreesToRadians(SpinSpeed) * DeltaTime, 2.f * PI);
+	const FQuat Spin(FVector::UpVector, SpinAngle);
+	for (int32 i = 0; i < CoinTransforms.Num(); i++)
+	{
+		FTransform& Transform = SpinTransforms[i];
+		Transform = CoinTransforms[i];
+		Transform.SetRotation(CoinTransforms[i].GetRotation() * Spin);
+		if (Collected[i])
+		{
+			Transform.SetScale3D(FVector::ZeroVector);
+		}
+	}
+
+	// One render state update for every coin
+	Coins->BatchUpdateInstancesTransforms(0, SpinTransforms, false, true, false);
+}
+
+void ACollectibleField::RecordCheckpoint()
+{
+	CollectedAtCheckpoint = Collected;
+}
+
+void ACollectibleField::RestoreCheckpoint()
+{
+	bool bChanged = false;
+	for (int32 i = 0; i < CoinTransforms.Num(); i++)
+	{
+		if (Collected[i] == CollectedAtCheckpoint[i]) { continue; }
+
+		Collected[i] = static_cast<bool>(CollectedAtCheckpoint[i]);
+		NumCollected += Collected[i] ? 1 : -1;
+		Coins->UpdateInstanceTransform(i, GetCoinTransform(i), false, false, true);
+		bChanged = true;
+	}
+	if (bChanged)
+	{
+		Coins->MarkRenderStateDirty();
+	}
+
+	// The player is put back somewhere else, that jump mustn't sweep up coins
+	bHasLastPlayerLocation = false;
+}
+
+void ACollectibleField::GetCollectedCoins(TArray<int32>& OutIndices) const
+{
+	OutIndices.Reset(NumCollected);
+	for (TConstSetBitIterator<> It(Collected); It; ++It)
+	{
+		OutIndices.Add(It.GetIndex());
+	}
+}
+
+void ACollectibleField::SetCollectedCoins(const TArray<int32>& Indices)
+{
+	bool bChanged = false;
+	for (int32 Index : Indices)
+	{
+		// The field may have been edited since the save
+		if (Collected.IsValidIndex(Index) == false || Collected[Index]) { continue; }
+
+		Collected[Index] = true;
+		NumCollected++;
+		Coins->UpdateInstanceTransform(Index, GetCoinTransform(Index), false, false, true);
+		bChanged = true;
+	}
+	if (bChanged)
+	{
+		Coins->MarkRenderStateDirty();
+	}
+}
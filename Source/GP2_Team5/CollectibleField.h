@@ -0,0 +1,112 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Enums.h"
+#include "CollectibleField.generated.h"
+
+//--- forward declarations ---
+class UHierarchicalInstancedStaticMeshComponent;
+class AGravityCharacter;
+
+/**
+ * All the coins of an area as instances of one mesh: one draw call and one tick instead of an actor, a sphere
+ * overlap and a rotating movement per coin. Coins are placed as instances of the Coins component, and spun by
+ * SpinMaterial rather than by transform updates, which would rebuild the instance tree every frame. Without one
+ * the coins on screen are spun by a batched transform update.
+ * The player is tested against a spatial hash of the coins, along the path it moved this frame, so fast movement
+ * doesn't skip any. Collected coins are scaled to zero, which keeps instance indices stable for checkpoint restores.
+ */
+UCLASS()
+class GP2_TEAM5_API ACollectibleField : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ACollectibleField();
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void Tick(float DeltaTime) override;
+
+	UFUNCTION(BlueprintPure, Category = "Collectible")
+	int32 GetNumCoins() const { return CoinTransforms.Num(); }
+
+	UFUNCTION(BlueprintPure, Category = "Collectible")
+	int32 GetNumCollected() const { return NumCollected; }
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Collectible")
+	void OnCoinPickedUp(AGravityCharacter* PickedBy, FVector Location);
+
+	// Used by UCheckpointSubsystem
+	void RecordCheckpoint();
+	void RestoreCheckpoint();
+
+	// Used by USaveGameSubsystem. Setting them doesn't give the player anything, its counts are saved on their own
+	void GetCollectedCoins(TArray<int32>& OutIndices) const;
+	void SetCollectedCoins(const TArray<int32>& Indices);
+
+protected:
+	// Range of CellCoins holding the coins of one hash cell
+	struct FCoinCell
+	{
+		int32 Start = 0;
+		int32 Num = 0;
+	};
+
+	void BuildHash();
+	FIntVector GetCell(const FVector& Location) const;
+	void PickUpAlong(AGravityCharacter* Player, const FVector& Start, const FVector& End);
+	void SetCoinCollected(int32 Index, bool bNewCollected);
+	void UpdateSpin(float DeltaTime);
+
+	// Bound to the Coins component, keeps the world space hash where the coins are
+	void OnCoinsMoved(USceneComponent* Component, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+	void UpdateCoinLocations();
+	FTransform GetCoinTransform(int32 Index) const;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Collectible")
+	UHierarchicalInstancedStaticMeshComponent* Coins = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Collectible")
+	ECollectibleType Type = ECollectibleType::Coin;
+
+	/* Amount of items added per coin */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Collectible")
+	int32 CountPerCoin = 1;
+
+	/* Distance (cm) from the player's location at which a coin is picked up */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Collectible")
+	float PickupRadius = 80.f;
+
+	/* Spins every coin around its own pivot in World Position Offset, e.g. RotateAboutAxis around the instance's
+	   position from TransformPosition in Instance & Particle Space. Applied to Coins at BeginPlay */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Collectible")
+	class UMaterialInterface* SpinMaterial = nullptr;
+
+	/* Degrees per second around each coin's up axis, when there is no SpinMaterial */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Collectible")
+	float SpinSpeed = 180.f;
+
+	// Instance transforms as placed, relative to the component
+	TArray<FTransform> CoinTransforms;
+	TArray<FTransform> SpinTransforms;
+	float SpinAngle = 0.f;
+
+	TBitArray<> Collected;
+	TBitArray<> CollectedAtCheckpoint;
+	int32 NumCollected = 0;
+
+	// Coins by world space cell of size 2 * PickupRadius
+	TMap<FIntVector, FCoinCell> Cells;
+	TArray<int32> CellCoins;
+	TArray<FVector> CoinLocations;
+	FBox CoinBounds { ForceInit };
+
+	// Further than this (cm) between two frames and the player is considered teleported
+	float MaxSweepDistance = 1000.f;
+	FVector LastPlayerLocation = FVector::ZeroVector;
+	bool bHasLastPlayerLocation = false;
+};
@@ -2,15 +2,15 @@
 
 
 #include "DeathTriggerComponent.h"
+#include "GameFramework/Pawn.h"
+#include "Kismet/GameplayStatics.h"
+#include "HazardSubsystem.h"
+#include "CheckpointSubsystem.h"
 
 // Sets default values for this component's properties
 UDeathTriggerComponent::UDeathTriggerComponent()
 {
-	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
-	// off to improve performance if you don't need them.
-	PrimaryComponentTick.bCanEverTick = true;
-
-	// ...
+	PrimaryComponentTick.bCanEverTick = false;
 }
 
 
@@ -19,16 +19,42 @@ void UDeathTriggerComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// ...
-	
+	if (UHazardSubsystem* Hazards = UHazardSubsystem::Get(this))
+	{
+		Hazards->OnPawnKilled.AddDynamic(this, &UDeathTriggerComponent::OnPawnKilled);
+	}
+	if (UCheckpointSubsystem* Checkpoints = UCheckpointSubsystem::Get(this))
+	{
+		Checkpoints->OnRespawned.AddDynamic(this, &UDeathTriggerComponent::OnRespawned);
+	}
 }
 
+void UDeathTriggerComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UHazardSubsystem* Hazards = UHazardSubsystem::Get(this))
+	{
+		Hazards->OnPawnKilled.RemoveDynamic(this, &UDeathTriggerComponent::OnPawnKilled);
+	}
+	if (UCheckpointSubsystem* Checkpoints = UCheckpointSubsystem::Get(this))
+	{
+		Checkpoints->OnRespawned.RemoveDynamic(this, &UDeathTriggerComponent::OnRespawned);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
 
-// Called every frame
-void UDeathTriggerComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+void UDeathTriggerComponent::OnPawnKilled(APawn* Pawn, UHazardComponent* Hazard)
 {
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	if (Pawn != GetOwner()) { return; }
 
-	// ...
+	isPlayerDead = true;
+	OnDeath.Broadcast(Hazard);
 }
 
+void UDeathTriggerComponent::OnRespawned(ACheckpoint* Checkpoint)
+{
+	// Only the player is respawned
+	if (GetOwner() != UGameplayStatics::GetPlayerPawn(this, 0)) { return; }
+
+	isPlayerDead = false;
+}
@@ -6,7 +6,10 @@
 #include "Components/ActorComponent.h"
 #include "DeathTriggerComponent.generated.h"
 
-
+/**
+ * Tells its owner when UHazardSubsystem kills it.
+ * isPlayerDead is set on death and cleared when UCheckpointSubsystem respawns the player.
+ */
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class GP2_TEAM5_API UDeathTriggerComponent : public UActorComponent
 {
@@ -19,15 +22,20 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "C++ Values")
 		bool isPlayerDead;
 
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDeath, class UHazardComponent*, Hazard);
 
+	/* Broadcast when the owner enters a hazard */
+	UPROPERTY(BlueprintAssignable, Category = "C++ Values")
+	FOnDeath OnDeath;
 
 protected:
 	// Called when the game starts
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
-public:	
-	// Called every frame
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	UFUNCTION()
+	void OnPawnKilled(APawn* Pawn, class UHazardComponent* Hazard);
 
-		
+	UFUNCTION()
+	void OnRespawned(class ACheckpoint* Checkpoint);
 };
@@ -28,6 +28,22 @@ enum class EHighlightType : uint8
 	NonClickable,
 };
 
+UENUM(BlueprintType)
+enum class ELaserSegmentType : uint8
+{
+	Arc,
+	Straight,
+};
+
+UENUM(BlueprintType)
+enum class EHazardShape : uint8
+{
+	Box,
+	Sphere,
+	// Everything between two distances from the component, e.g. the core or the space around a planet
+	AltitudeBand,
+};
+
 class GP2_TEAM5_API Enums
 {
 public:
@@ -17,6 +17,9 @@ public class GP2_Team5 : ModuleRules
 			"UMG", 
 			"AIModule",
 			"ApexDestruction",
+			"PhysicsCore",
+			"PhysX",
+			"APEX",
 		});
 	}
 }
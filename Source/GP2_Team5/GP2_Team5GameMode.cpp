@@ -2,8 +2,19 @@
 
 #include "GP2_Team5GameMode.h"
 #include "UObject/ConstructorHelpers.h"
+#include "SaveGameSubsystem.h"
 
 AGP2_Team5GameMode::AGP2_Team5GameMode()
 {
 
 }
+
+void AGP2_Team5GameMode::StartPlay()
+{
+	Super::StartPlay();
+
+	if (USaveGameSubsystem* Saves = USaveGameSubsystem::Get(this))
+	{
+		Saves->ApplyProgress();
+	}
+}
@@ -13,6 +13,9 @@ class AGP2_Team5GameMode : public AGameModeBase
 
 public:
 	AGP2_Team5GameMode();
+
+	// Puts the saved progress back once every actor of the level has begun play
+	virtual void StartPlay() override;
 };
 
 
@@ -0,0 +1,491 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GravityApplicatorSubsystem.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "Kismet/GameplayStatics.h"
+#include "Components/PrimitiveComponent.h"
+#include "PhysicsEngine/BodyInstance.h"
+#include "GravitySwapComponent.h"
+#include <../Plugins/Runtime/ApexDestruction/Source/ApexDestruction/Public/DestructibleComponent.h>
+#if WITH_PHYSX
+#include "PhysXPublic.h"
+#include "Physics/PhysicsInterfaceCore.h"
+#endif
+
+void FGravityLODTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Subsystem != nullptr)
+	{
+		Subsystem->UpdateLOD(DeltaTime);
+	}
+}
+
+FString FGravityLODTickFunction::DiagnosticMessage()
+{
+	return TEXT("UGravityApplicatorSubsystem::UpdateLOD");
+}
+
+void UGravityApplicatorSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	LODTickFunction.bCanEverTick = true;
+	LODTickFunction.bStartWithTickEnabled = true;
+	LODTickFunction.TickGroup = TG_PrePhysics;
+	LODTickFunction.Subsystem = this;
+}
+
+void UGravityApplicatorSubsystem::Deinitialize()
+{
+	if (LODTickFunction.IsTickFunctionRegistered())
+	{
+		LODTickFunction.UnRegisterTickFunction();
+	}
+	LODTickFunction.Subsystem = nullptr;
+
+	UWorld* World = GetWorld();
+	FPhysScene* PhysScene = World != nullptr ? World->GetPhysicsScene() : nullptr;
+	if (PhysScene != nullptr && PhysSceneStepHandle.IsValid())
+	{
+		PhysScene->OnPhysSceneStep.Remove(PhysSceneStepHandle);
+	}
+	PhysSceneStepHandle.Reset();
+
+	for (UGravitySwapComponent* Comp : Owners)
+	{
+		Comp->ApplicatorIndex = INDEX_NONE;
+	}
+
+	FScopeLock Lock(&BodiesLock);
+	Bodies.Reset();
+	FlipSigns.Reset();
+	GravityPoints.Reset();
+	Accelerations.Reset();
+	AllowSleep.Reset();
+	States.Reset();
+	RestTimes.Reset();
+	AllowLOD.Reset();
+	LODVelocities.Reset();
+	LODExitRequests.Reset();
+	LODHadHitNotify.Reset();
+	Owners.Reset();
+#if WITH_APEX
+	Destructibles.Reset();
+#endif
+
+	Super::Deinitialize();
+}
+
+UGravityApplicatorSubsystem* UGravityApplicatorSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject != nullptr ? WorldContextObject->GetWorld() : nullptr;
+	if (World == nullptr || World->IsGameWorld() == false) { return nullptr; }
+
+	return World->GetSubsystem<UGravityApplicatorSubsystem>();
+}
+
+void UGravityApplicatorSubsystem::BindToPhysicsScene()
+{
+	if (PhysSceneStepHandle.IsValid()) { return; }
+
+	FPhysScene* PhysScene = GetWorld()->GetPhysicsScene();
+	if (PhysScene == nullptr) { return; }
+
+	PhysSceneStepHandle = PhysScene->OnPhysSceneStep.AddUObject(this, &UGravityApplicatorSubsystem::OnPhysSceneStep);
+}
+
+bool UGravityApplicatorSubsystem::Register(UGravitySwapComponent* Comp)
+{
+	if (Comp == nullptr || Comp->PhysicsComp == nullptr) { return false; }
+	if (Comp->ApplicatorIndex != INDEX_NONE) { return true; }
+
+	FBodyInstance* Body = Comp->PhysicsComp->GetBodyInstance();
+	if (Body == nullptr) { return false; }
+
+	BindToPhysicsScene();
+	if (PhysSceneStepHandle.IsValid() == false) { return false; }
+
+	// Registered lazily since the persistent level isn't guaranteed to exist when the subsystem initializes
+	if (LODTickFunction.IsTickFunctionRegistered() == false && GetWorld()->PersistentLevel != nullptr)
+	{
+		LODTickFunction.RegisterTickFunction(GetWorld()->PersistentLevel);
+	}
+
+	FScopeLock Lock(&BodiesLock);
+	Comp->ApplicatorIndex = Bodies.Add(Body);
+	FlipSigns.Add(Comp->bFlipGravity ? -1.f : 1.f);
+	GravityPoints.Add(Comp->GravityPoint);
+	Accelerations.Add(Comp->GravityAcceleration);
+	AllowSleep.Add(Comp->bAllowSleep);
+	States.Add(EGravityBodyState::Active);
+	RestTimes.Add(0.f);
+	AllowLOD.Add(Comp->bAllowKinematicLOD);
+	LODVelocities.Add(FVector::ZeroVector);
+	LODExitRequests.Add(false);
+	LODHadHitNotify.Add(false);
+	Owners.Add(Comp);
+#if WITH_APEX
+	Destructibles.Add(Cast<UDestructibleComponent>(Comp->PhysicsComp));
+#endif
+	return true;
+}
+
+void UGravityApplicatorSubsystem::Unregister(UGravitySwapComponent* Comp)
+{
+	if (Comp == nullptr || Owners.IsValidIndex(Comp->ApplicatorIndex) == false) { return; }
+
+	const int32 Index = Comp->ApplicatorIndex;
+
+	// Leaves the body simulating, the way it was before it was registered
+	if (States[Index] == EGravityBodyState::Kinematic)
+	{
+		ExitLOD(Index, Comp->PhysicsComp);
+	}
+	Comp->ApplicatorIndex = INDEX_NONE;
+
+	FScopeLock Lock(&BodiesLock);
+	Bodies.RemoveAtSwap(Index, 1, false);
+	FlipSigns.RemoveAtSwap(Index, 1, false);
+	GravityPoints.RemoveAtSwap(Index, 1, false);
+	Accelerations.RemoveAtSwap(Index, 1, false);
+	AllowSleep.RemoveAtSwap(Index, 1, false);
+	States.RemoveAtSwap(Index, 1, false);
+	RestTimes.RemoveAtSwap(Index, 1, false);
+	AllowLOD.RemoveAtSwap(Index, 1, false);
+	LODVelocities.RemoveAtSwap(Index, 1, false);
+	LODExitRequests.RemoveAtSwap(Index, 1, false);
+	LODHadHitNotify.RemoveAtSwap(Index, 1, false);
+	Owners.RemoveAtSwap(Index, 1, false);
+#if WITH_APEX
+	Destructibles.RemoveAtSwap(Index, 1, false);
+#endif
+
+	// The last entry moved into the freed slot
+	if (Owners.IsValidIndex(Index))
+	{
+		Owners[Index]->ApplicatorIndex = Index;
+	}
+}
+
+void UGravityApplicatorSubsystem::SetFlipGravity(const UGravitySwapComponent* Comp, bool bFlipGravity)
+{
+	if (Comp == nullptr || FlipSigns.IsValidIndex(Comp->ApplicatorIndex) == false) { return; }
+
+	ExitLODForWake(Comp->ApplicatorIndex);
+
+	FScopeLock Lock(&BodiesLock);
+	FlipSigns[Comp->ApplicatorIndex] = bFlipGravity ? -1.f : 1.f;
+	WakeAt(Comp->ApplicatorIndex);
+}
+
+void UGravityApplicatorSubsystem::SetGravityPoint(const UGravitySwapComponent* Comp, const FVector& GravityPoint)
+{
+	if (Comp == nullptr || GravityPoints.IsValidIndex(Comp->ApplicatorIndex) == false) { return; }
+
+	ExitLODForWake(Comp->ApplicatorIndex);
+
+	FScopeLock Lock(&BodiesLock);
+	GravityPoints[Comp->ApplicatorIndex] = GravityPoint;
+	WakeAt(Comp->ApplicatorIndex);
+}
+
+void UGravityApplicatorSubsystem::Wake(const UGravitySwapComponent* Comp)
+{
+	if (Comp == nullptr || States.IsValidIndex(Comp->ApplicatorIndex) == false) { return; }
+
+	ExitLODForWake(Comp->ApplicatorIndex);
+
+	FScopeLock Lock(&BodiesLock);
+	WakeAt(Comp->ApplicatorIndex);
+}
+
+void UGravityApplicatorSubsystem::WakeAt(int32 Index)
+{
+	if (States[Index] == EGravityBodyState::Active) { return; }
+
+	States[Index] = EGravityBodyState::Active;
+	RestTimes[Index] = 0.f;
+	if (Bodies[Index] != nullptr)
+	{
+		Bodies[Index]->WakeInstance();
+	}
+}
+
+void UGravityApplicatorSubsystem::OnPhysSceneStep(FPhysScene* PhysScene, float DeltaTime)
+{
+	FScopeLock Lock(&BodiesLock);
+
+	// Only touches the flat arrays and body instances, no UObjects besides reading a destructible's APEX actor
+	for (int32 i = 0; i < Bodies.Num(); i++)
+	{
+#if WITH_APEX
+		if (Destructibles[i] != nullptr)
+		{
+			ApplyChunkGravity(i);
+			continue;
+		}
+#endif
+
+		FBodyInstance* Body = Bodies[i];
+		if (Body == nullptr || Body->IsInstanceSimulatingPhysics() == false) { continue; }
+
+		if (AllowSleep[i] && UpdateSleepState(i, Body, DeltaTime) == false) { continue; }
+
+		const FVector Location = Body->GetUnrealWorldTransform_AssumesLocked().GetLocation();
+		const FVector GravityDirection = (GravityPoints[i] - Location).GetSafeNormal();
+
+		const FVector Acceleration = GravityDirection * Accelerations[i] * FlipSigns[i];
+
+		// Still pulled down while resting, so a body whose support went away falls instead of hanging until it sleeps
+		if (States[i] == EGravityBodyState::Resting)
+		{
+			AddAccelerationWithoutWaking(Body, Acceleration);
+			continue;
+		}
+
+		// Acceleration change, so the body's mass doesn't matter
+		Body->AddForce(Acceleration, false, true);
+	}
+}
+
+void UGravityApplicatorSubsystem::AddAccelerationWithoutWaking(FBodyInstance* Body, const FVector& Acceleration)
+{
+#if WITH_PHYSX
+	FPhysicsCommand::ExecuteWrite(Body->ActorHandle, [&Acceleration](const FPhysicsActorHandle& Actor)
+	{
+		if (physx::PxRigidDynamic* Rigid = FPhysicsInterface::GetPxRigidDynamic_AssumesLocked(Actor))
+		{
+			Rigid->addForce(U2PVector(Acceleration), physx::PxForceMode::eACCELERATION, false);
+		}
+	});
+#else
+	Body->AddForce(Acceleration, false, true);
+#endif
+}
+
+bool UGravityApplicatorSubsystem::UpdateSleepState(int32 Index, FBodyInstance* Body, float DeltaTime)
+{
+	EGravityBodyState& State = States[Index];
+
+	if (Body->IsInstanceAwake() == false)
+	{
+		State = EGravityBodyState::Sleeping;
+		return false;
+	}
+
+	// Woken by the physics engine, e.g. by a contact or by its support going away
+	if (State == EGravityBodyState::Sleeping)
+	{
+		State = EGravityBodyState::Active;
+		RestTimes[Index] = 0.f;
+	}
+
+	const float SpeedSquared = Body->GetUnrealWorldVelocity_AssumesLocked().SizeSquared();
+
+	if (State == EGravityBodyState::Resting)
+	{
+		// Pushed, or falling now that its support went away
+		if (SpeedSquared >= FMath::Square(WakeSpeedThreshold))
+		{
+			State = EGravityBodyState::Active;
+			RestTimes[Index] = 0.f;
+		}
+		return true;
+	}
+
+	if (SpeedSquared < FMath::Square(RestSpeedThreshold))
+	{
+		// Gravity keeps being applied while settling, so only a body supported along its gravity vector stays this slow
+		RestTimes[Index] += DeltaTime;
+		State = RestTimes[Index] >= RestDelay ? EGravityBodyState::Resting : EGravityBodyState::Settling;
+		return true;
+	}
+
+	State = EGravityBodyState::Active;
+	RestTimes[Index] = 0.f;
+	return true;
+}
+
+void UGravityApplicatorSubsystem::ApplyChunkGravity(int32 Index)
+{
+#if WITH_APEX
+	// Releasing the actor is deferred until after the step, so one that is set now stays valid through it
+	nvidia::apex::DestructibleActor* ApexActor = Destructibles[Index]->ApexDestructibleActor;
+	if (ApexActor == nullptr) { return; }
+
+	// Only dynamic chunks. A destructible that hasn't fractured is a single chunk
+	physx::PxRigidDynamic** Chunks = nullptr;
+	const uint32 NumChunks = ApexActor->acquirePhysXActorBuffer(Chunks, nvidia::apex::DestructiblePhysXActorQueryFlags::Dynamic);
+	if (NumChunks > 0 && Chunks != nullptr)
+	{
+		SCOPED_SCENE_WRITE_LOCK(Chunks[0]->getScene());
+
+		const FVector GravityPoint = GravityPoints[Index];
+		const float Acceleration = Accelerations[Index] * FlipSigns[Index];
+		const float MinHalfSize = MinChunkSize * 0.5f;
+
+		for (uint32 i = 0; i < NumChunks; i++)
+		{
+			physx::PxRigidDynamic* Chunk = Chunks[i];
+			if (Chunk == nullptr || Chunk->isSleeping()) { continue; }
+			if (Chunk->getWorldBounds().getExtents().maxElement() < MinHalfSize) { continue; }
+
+			const FVector Location = P2UVector(Chunk->getGlobalPose().p);
+			const FVector GravityDirection = (GravityPoint - Location).GetSafeNormal();
+			Chunk->addForce(U2PVector(GravityDirection * Acceleration), physx::PxForceMode::eACCELERATION, false);
+		}
+	}
+	ApexActor->releasePhysXActorBuffer();
+#endif
+}
+
+int32 UGravityApplicatorSubsystem::GetNumKinematicBodies() const
+{
+	int32 Count = 0;
+	for (EGravityBodyState State : States)
+	{
+		Count += State == EGravityBodyState::Kinematic ? 1 : 0;
+	}
+	return Count;
+}
+
+bool UGravityApplicatorSubsystem::IsKinematicLOD(const UGravitySwapComponent* Comp) const
+{
+	return Comp != nullptr && States.IsValidIndex(Comp->ApplicatorIndex) && States[Comp->ApplicatorIndex] == EGravityBodyState::Kinematic;
+}
+
+FVector UGravityApplicatorSubsystem::GetLODVelocity(const UGravitySwapComponent* Comp) const
+{
+	return IsKinematicLOD(Comp) ? LODVelocities[Comp->ApplicatorIndex] : FVector::ZeroVector;
+}
+
+void UGravityApplicatorSubsystem::UpdateLOD(float DeltaTime)
+{
+	APawn* Player = UGameplayStatics::GetPlayerPawn(this, 0);
+	if (Player == nullptr) { return; }
+
+	const FVector PlayerLocation = Player->GetActorLocation();
+	const float EnterDistanceSquared = FMath::Square(LODDistance);
+	const float ExitDistanceSquared = FMath::Square(LODDistance - LODHysteresis);
+
+	// Engine calls are made outside BodiesLock. Only the game thread changes the arrays, so reading them here is safe
+	for (int32 i = 0; i < Owners.Num(); i++)
+	{
+		if (AllowLOD[i] == false) { continue; }
+#if WITH_APEX
+		if (Destructibles[i] != nullptr) { continue; }
+#endif
+
+		UPrimitiveComponent* PhysicsComp = Owners[i]->PhysicsComp;
+		if (PhysicsComp == nullptr) { continue; }
+
+		const float DistanceSquared = FVector::DistSquared(PlayerLocation, PhysicsComp->GetComponentLocation());
+		if (States[i] == EGravityBodyState::Kinematic)
+		{
+			if (LODExitRequests[i] || DistanceSquared < ExitDistanceSquared)
+			{
+				ExitLOD(i, PhysicsComp);
+				continue;
+			}
+			MoveKinematic(i, PhysicsComp, DeltaTime);
+		}
+		else if (DistanceSquared > EnterDistanceSquared && CanEnterLOD(i, PhysicsComp))
+		{
+			EnterLOD(i, PhysicsComp);
+		}
+	}
+}
+
+bool UGravityApplicatorSubsystem::CanEnterLOD(int32 Index, UPrimitiveComponent* PhysicsComp) const
+{
+	// Bodies at rest already cost nothing once the physics engine puts them to sleep
+	if (PhysicsComp->IsSimulatingPhysics() == false || States[Index] != EGravityBodyState::Active) { return false; }
+
+	if (PhysicsComp->GetPhysicsAngularVelocityInRadians().SizeSquared() > FMath::Square(MaxLODAngularSpeed)) { return false; }
+
+	// Only a fall along the gravity vector can be continued analytically
+	const FVector GravityDirection = (GravityPoints[Index] - PhysicsComp->GetComponentLocation()).GetSafeNormal() * FlipSigns[Index];
+	const FVector Velocity = PhysicsComp->GetPhysicsLinearVelocity();
+	const float FallSpeed = Velocity | GravityDirection;
+	if (FallSpeed < RestSpeedThreshold) { return false; }
+
+	const FVector Tangential = Velocity - GravityDirection * FallSpeed;
+	return Tangential.SizeSquared() < FMath::Square(MaxLODTangentialSpeed);
+}
+
+void UGravityApplicatorSubsystem::EnterLOD(int32 Index, UPrimitiveComponent* PhysicsComp)
+{
+	LODVelocities[Index] = PhysicsComp->GetPhysicsLinearVelocity();
+	LODExitRequests[Index] = false;
+
+	PhysicsComp->SetSimulatePhysics(false);
+
+	// Simulated bodies hitting the kinematic one bring it back to simulation
+	LODHadHitNotify[Index] = PhysicsComp->BodyInstance.bNotifyRigidBodyCollision;
+	PhysicsComp->SetNotifyRigidBodyCollision(true);
+	PhysicsComp->OnComponentHit.AddUniqueDynamic(this, &UGravityApplicatorSubsystem::OnKinematicBodyHit);
+
+	FScopeLock Lock(&BodiesLock);
+	States[Index] = EGravityBodyState::Kinematic;
+	RestTimes[Index] = 0.f;
+}
+
+void UGravityApplicatorSubsystem::ExitLOD(int32 Index, UPrimitiveComponent* PhysicsComp)
+{
+	if (PhysicsComp != nullptr)
+	{
+		PhysicsComp->OnComponentHit.RemoveDynamic(this, &UGravityApplicatorSubsystem::OnKinematicBodyHit);
+		PhysicsComp->SetNotifyRigidBodyCollision(LODHadHitNotify[Index]);
+		PhysicsComp->SetSimulatePhysics(true);
+		PhysicsComp->SetPhysicsLinearVelocity(LODVelocities[Index]);
+	}
+	LODVelocities[Index] = FVector::ZeroVector;
+	LODExitRequests[Index] = false;
+
+	FScopeLock Lock(&BodiesLock);
+	States[Index] = EGravityBodyState::Active;
+	RestTimes[Index] = 0.f;
+}
+
+void UGravityApplicatorSubsystem::ExitLODForWake(int32 Index)
+{
+	if (States[Index] == EGravityBodyState::Kinematic)
+	{
+		ExitLOD(Index, Owners[Index]->PhysicsComp);
+	}
+}
+
+void UGravityApplicatorSubsystem::MoveKinematic(int32 Index, UPrimitiveComponent* PhysicsComp, float DeltaTime)
+{
+	const FVector Location = PhysicsComp->GetComponentLocation();
+	const FVector GravityDirection = (GravityPoints[Index] - Location).GetSafeNormal();
+	FVector& Velocity = LODVelocities[Index];
+	Velocity += GravityDirection * Accelerations[Index] * FlipSigns[Index] * DeltaTime;
+
+	FHitResult Hit;
+	PhysicsComp->SetWorldLocation(Location + Velocity * DeltaTime, true, &Hit);
+	if (Hit.bBlockingHit == false) { return; }
+
+	// Landed. Resting is left to the simulation, which puts the body to sleep. Landing on something that moves keeps the fall's speed
+	UPrimitiveComponent* HitComp = Hit.GetComponent();
+	if (HitComp == nullptr || HitComp->Mobility != EComponentMobility::Movable)
+	{
+		Velocity = FVector::ZeroVector;
+	}
+	LODExitRequests[Index] = true;
+}
+
+void UGravityApplicatorSubsystem::OnKinematicBodyHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
+{
+	// Rare, only kinematic bodies are bound, so a scan is fine. The switch happens on the next LOD update
+	for (int32 i = 0; i < Owners.Num(); i++)
+	{
+		if (Owners[i]->PhysicsComp == HitComp && States[i] == EGravityBodyState::Kinematic)
+		{
+			LODExitRequests[i] = true;
+			return;
+		}
+	}
+}
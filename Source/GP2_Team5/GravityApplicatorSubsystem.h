@@ -0,0 +1,142 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PhysicsPublic.h"
+#include "Engine/EngineBaseTypes.h"
+#include "GravityApplicatorSubsystem.generated.h"
+
+//--- forward declarations ---
+class UGravitySwapComponent;
+class UGravityApplicatorSubsystem;
+struct FBodyInstance;
+class UDestructibleComponent;
+
+// Where a registered body is in its way to sleep
+enum class EGravityBodyState : uint8
+{
+	Active,		// Gravity is applied
+	Settling,	// Slow enough to rest, waiting for RestDelay to pass
+	Resting,	// Gravity is applied without keeping the body awake, so the physics engine can put it to sleep
+	Sleeping,	// Put to sleep by the physics engine
+	Kinematic,	// Far from the player. Simulation is off and the body is moved analytically on the game thread
+};
+
+// Runs the physics LOD on the game thread before physics
+struct FGravityLODTickFunction : public FTickFunction
+{
+	UGravityApplicatorSubsystem* Subsystem = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+/**
+ * Applies radial (or flipped) gravity to every registered swappable body from one physics step callback,
+ * instead of every UGravitySwapComponent ticking and adding a frame-delta scaled force.
+ * The callback runs once per physics substep, so the result doesn't depend on frame rate.
+ * Bodies far from the player that are falling straight towards their gravity point are switched to
+ * kinematic and moved analytically, and get their simulation back when the player comes close or something hits them.
+ */
+UCLASS()
+class GP2_TEAM5_API UGravityApplicatorSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	static UGravityApplicatorSubsystem* Get(const UObject* WorldContextObject);
+
+	// Returns false if the component has no body to drive. In that case it should keep ticking itself
+	bool Register(UGravitySwapComponent* Comp);
+	void Unregister(UGravitySwapComponent* Comp);
+
+	void SetFlipGravity(const UGravitySwapComponent* Comp, bool bFlipGravity);
+	void SetGravityPoint(const UGravitySwapComponent* Comp, const FVector& GravityPoint);
+
+	// Resumes gravity on a resting or sleeping body
+	void Wake(const UGravitySwapComponent* Comp);
+
+	int32 GetNumBodies() const { return Bodies.Num(); }
+	int32 GetNumKinematicBodies() const;
+	bool IsKinematicLOD(const UGravitySwapComponent* Comp) const;
+	FVector GetLODVelocity(const UGravitySwapComponent* Comp) const;
+
+	// Switches bodies in and out of kinematic LOD and moves the kinematic ones
+	void UpdateLOD(float DeltaTime);
+
+protected:
+	void BindToPhysicsScene();
+	void OnPhysSceneStep(FPhysScene* PhysScene, float DeltaTime);
+	void WakeAt(int32 Index);
+
+	// Returns true if gravity should be applied to the body this step
+	bool UpdateSleepState(int32 Index, FBodyInstance* Body, float DeltaTime);
+
+	// Like FBodyInstance::AddForce, but doesn't reset the body's wake counter
+	void AddAccelerationWithoutWaking(FBodyInstance* Body, const FVector& Acceleration);
+
+	// Applies gravity to every awake chunk of a destructible, fractured or not
+	void ApplyChunkGravity(int32 Index);
+
+	// Falling along the gravity vector without spinning
+	bool CanEnterLOD(int32 Index, UPrimitiveComponent* PhysicsComp) const;
+	void EnterLOD(int32 Index, UPrimitiveComponent* PhysicsComp);
+	void ExitLOD(int32 Index, UPrimitiveComponent* PhysicsComp);
+	void ExitLODForWake(int32 Index);
+	void MoveKinematic(int32 Index, UPrimitiveComponent* PhysicsComp, float DeltaTime);
+
+	UFUNCTION()
+	void OnKinematicBodyHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
+
+	// Registered bodies, one entry per component, same index in every array
+	TArray<FBodyInstance*> Bodies;
+	TArray<float> FlipSigns;
+	TArray<FVector> GravityPoints;
+	TArray<float> Accelerations;
+	TArray<bool> AllowSleep;
+	TArray<EGravityBodyState> States;
+	TArray<float> RestTimes;
+	TArray<bool> AllowLOD;
+
+	// Kinematic LOD state. Only touched on the game thread
+	TArray<FVector> LODVelocities;
+	TArray<bool> LODExitRequests;
+	TArray<bool> LODHadHitNotify;
+	TArray<UGravitySwapComponent*> Owners;
+
+#if WITH_APEX
+	// Destructible of the entry, nullptr for plain bodies. Its APEX actor is read every step since recreating
+	// the physics state frees it
+	TArray<UDestructibleComponent*> Destructibles;
+#endif
+
+	// Chunks smaller than this (cm, largest bounds extent) are left alone
+	float MinChunkSize = 5.f;
+
+	// A body slower than this (cm/s) for RestDelay seconds stops receiving gravity
+	float RestSpeedThreshold = 5.f;
+	float RestDelay = 0.5f;
+
+	// A resting body pushed faster than this (cm/s) is active again
+	float WakeSpeedThreshold = 15.f;
+
+	// Bodies further than this (cm) from the player may go kinematic. They simulate again inside LODDistance - LODHysteresis
+	float LODDistance = 4000.f;
+	float LODHysteresis = 500.f;
+
+	// A falling body only goes kinematic if its sideways speed (cm/s) and spin (rad/s) are below these
+	float MaxLODTangentialSpeed = 20.f;
+	float MaxLODAngularSpeed = 0.2f;
+
+	// Guards the arrays against the physics step, which may run off the game thread
+	FCriticalSection BodiesLock;
+
+	FDelegateHandle PhysSceneStepHandle;
+
+	FGravityLODTickFunction LODTickFunction;
+};
@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GravityCameraRigComponent.h"
+#include "GameFramework/SpringArmComponent.h"
+#include "GameFramework/PawnMovementComponent.h"
+#include "GameFramework/Pawn.h"
+#include "GravityCharacter.h"
+
+// Critically damped spring towards zero. Error and Velocity are updated in place
+static void CriticallyDampedSpring(FVector& Error, FVector& Velocity, float SmoothTime, float DeltaTime)
+{
+	const float Omega = 2.f / SmoothTime;
+	const float X = Omega * DeltaTime;
+	const float Exp = 1.f / (1.f + X + 0.48f * X * X + 0.235f * X * X * X);
+
+	const FVector Temp = (Velocity + Omega * Error) * DeltaTime;
+	Velocity = (Velocity - Omega * Temp) * Exp;
+	Error = (Error + Temp) * Exp;
+}
+
+UGravityCameraRigComponent::UGravityCameraRigComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+}
+
+void UGravityCameraRigComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	SpringArm = Cast<USpringArmComponent>(GetOwner()->GetComponentByClass(USpringArmComponent::StaticClass()));
+	if (SpringArm == nullptr)
+	{
+		SetComponentTickEnabled(false);
+		return;
+	}
+
+	SnapToTarget();
+}
+
+void UGravityCameraRigComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (SpringArm == nullptr || DeltaTime <= 0.f) { return; }
+
+	// Error as a rotation vector from target to current, taking the shortest way around
+	const FQuat TargetRotation = CalculateTargetRotation();
+	FQuat Delta = CurrentRotation * TargetRotation.Inverse();
+	if (Delta.W < 0.f)
+	{
+		Delta = Delta * -1.f;
+	}
+
+	FVector Axis;
+	float Angle;
+	Delta.ToAxisAndAngle(Axis, Angle);
+	FVector Error = Axis * Angle;
+
+	CriticallyDampedSpring(Error, AngularVelocity, SmoothTime, DeltaTime);
+
+	const float NewAngle = Error.Size();
+	CurrentRotation = NewAngle > SMALL_NUMBER ? FQuat(Error / NewAngle, NewAngle) * TargetRotation : TargetRotation;
+	CurrentRotation.Normalize();
+
+	CurrentLookAhead = CalculateLookAhead(DeltaTime);
+
+	ApplyToSpringArm(false);
+}
+
+void UGravityCameraRigComponent::SnapToTarget()
+{
+	CurrentRotation = CalculateTargetRotation();
+	AngularVelocity = FVector::ZeroVector;
+	CurrentLookAhead = FVector::ZeroVector;
+	LookAheadVelocity = FVector::ZeroVector;
+
+	ApplyToSpringArm(true);
+}
+
+FQuat UGravityCameraRigComponent::CalculateTargetRotation() const
+{
+	const AGravityCharacter* Character = Cast<AGravityCharacter>(GetOwner());
+	const FVector GravityPoint = Character != nullptr ? Character->GetGravityPoint() : FVector::ZeroVector;
+
+	// Three vectors making the rotation space for the camera
+	const FVector ForwardVector{ -1.0f, 0.0f, 0.0f };
+	FVector UpVector = (GetOwner()->GetActorLocation() - GravityPoint).GetSafeNormal();
+	if (UpVector.IsNearlyZero())
+	{
+		UpVector = FVector::UpVector;
+	}
+	const FVector RightVector = FVector::CrossProduct(UpVector, ForwardVector);
+
+	return FQuat(FMatrix(ForwardVector, RightVector, UpVector, FVector::ZeroVector));
+}
+
+FVector UGravityCameraRigComponent::CalculateLookAhead(float DeltaTime)
+{
+	if (LookAheadDistance == 0.f) { return FVector::ZeroVector; }
+
+	const APawn* Pawn = Cast<APawn>(GetOwner());
+	const UPawnMovementComponent* Movement = Pawn != nullptr ? Pawn->GetMovementComponent() : nullptr;
+	if (Movement == nullptr || Movement->GetMaxSpeed() <= 0.f) { return FVector::ZeroVector; }
+
+	// The gravity tangent is the camera's right axis, the same axis the player moves along
+	const FVector Tangent = CurrentRotation.GetAxisY();
+	const float SpeedAlongTangent = FVector::DotProduct(Movement->Velocity, Tangent) / Movement->GetMaxSpeed();
+	const FVector TargetLookAhead = Tangent * FMath::Clamp(SpeedAlongTangent, -1.f, 1.f) * LookAheadDistance;
+
+	FVector Error = CurrentLookAhead - TargetLookAhead;
+	CriticallyDampedSpring(Error, LookAheadVelocity, LookAheadSmoothTime, DeltaTime);
+	return TargetLookAhead + Error;
+}
+
+void UGravityCameraRigComponent::ApplyToSpringArm(bool bForce)
+{
+	if (SpringArm == nullptr) { return; }
+
+	if (bForce || AppliedRotation.AngularDistance(CurrentRotation) > FMath::DegreesToRadians(RotationThreshold))
+	{
+		SpringArm->SetWorldRotation(CurrentRotation);
+		AppliedRotation = CurrentRotation;
+	}
+
+	if (bForce || FVector::DistSquared(AppliedLookAhead, CurrentLookAhead) > FMath::Square(LookAheadThreshold))
+	{
+		SpringArm->TargetOffset += CurrentLookAhead - AppliedLookAhead;
+		AppliedLookAhead = CurrentLookAhead;
+	}
+}
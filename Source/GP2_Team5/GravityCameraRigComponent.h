@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "GravityCameraRigComponent.generated.h"
+
+/**
+ * Rotates the owner's spring arm so the camera's up always points away from the gravity point.
+ * Runs a critically damped spring in quaternion space after physics, and only pushes a new
+ * transform to the spring arm when the change is above a threshold.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class GP2_TEAM5_API UGravityCameraRigComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UGravityCameraRigComponent();
+
+protected:
+	virtual void BeginPlay() override;
+
+public:
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	// Jumps straight to the target rotation, e.g. after a respawn
+	UFUNCTION(BlueprintCallable, Category = "Camera")
+	void SnapToTarget();
+
+protected:
+	FQuat CalculateTargetRotation() const;
+	FVector CalculateLookAhead(float DeltaTime);
+	void ApplyToSpringArm(bool bForce);
+
+	/* Time it takes the spring to mostly catch up with the target rotation */
+	UPROPERTY(EditAnywhere, Category = "Camera", meta = (ClampMin = "0.01"))
+	float SmoothTime = 0.12f;
+
+	/* Rotation changes smaller than this (in degrees) don't update the spring arm */
+	UPROPERTY(EditAnywhere, Category = "Camera", meta = (ClampMin = "0.0"))
+	float RotationThreshold = 0.05f;
+
+	/* How far ahead of the player the camera looks along the gravity tangent at full speed */
+	UPROPERTY(EditAnywhere, Category = "Camera|LookAhead")
+	float LookAheadDistance = 0.f;
+
+	UPROPERTY(EditAnywhere, Category = "Camera|LookAhead", meta = (ClampMin = "0.01"))
+	float LookAheadSmoothTime = 0.5f;
+
+	/* Look ahead changes smaller than this (in units) don't update the spring arm */
+	UPROPERTY(EditAnywhere, Category = "Camera|LookAhead", meta = (ClampMin = "0.0"))
+	float LookAheadThreshold = 1.f;
+
+	UPROPERTY()
+	class USpringArmComponent* SpringArm = nullptr;
+
+	FQuat CurrentRotation = FQuat::Identity;
+	FVector AngularVelocity = FVector::ZeroVector;
+	FQuat AppliedRotation = FQuat::Identity;
+
+	FVector CurrentLookAhead = FVector::ZeroVector;
+	FVector LookAheadVelocity = FVector::ZeroVector;
+	FVector AppliedLookAhead = FVector::ZeroVector;
+};
@@ -7,6 +7,8 @@
 #include "Components/BoxComponent.h"
 #include "Components/InputComponent.h"
 #include "GameFramework/SpringArmComponent.h"
+#include "GravityCameraRigComponent.h"
+#include "SwapTrajectoryPreviewComponent.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "Kismet/KismetSystemLibrary.h"
 #include "GameFramework/CharacterMovementComponent.h"
@@ -15,6 +17,8 @@
 #include "ClickInteractComponent.h"
 #include "DrawDebugHelpers.h"
 #include "GravitySwapComponent.h"
+#include "GravitySwapSubsystem.h"
+#include "InteractionTrace.h"
 #include <TimerManager.h>
 
 // Sets default values
@@ -46,6 +50,11 @@ AGravityCharacter::AGravityCharacter(const FObjectInitializer& ObjectInitializer
 	SideViewCameraComponent->SetupAttachment(CameraBoom, USpringArmComponent::SocketName);
 	SideViewCameraComponent->bUsePawnControlRotation = false; // We don't want the controller rotating the camera
 
+	// Create the rig that keeps the boom aligned with gravity
+	CameraRig = CreateDefaultSubobject<UGravityCameraRigComponent>(TEXT("CameraRig"));
+
+	SwapPreview = CreateDefaultSubobject<USwapTrajectoryPreviewComponent>(TEXT("SwapPreview"));
+
 	// Configure character movement
 	GetCharacterMovement()->bOrientRotationToMovement = true; // Face in the direction we are moving..
 	GetCharacterMovement()->RotationRate = FRotator(0.0f, 720.0f, 0.0f); // ...at this rotation rate
@@ -56,6 +65,12 @@ AGravityCharacter::AGravityCharacter(const FObjectInitializer& ObjectInitializer
 	GetCharacterMovement()->MaxWalkSpeed = 600.f;
 	GetCharacterMovement()->MaxFlySpeed = 600.f;
 
+	// Keep Character locked in X axis at all times
+	GetCharacterMovement()->SetPlaneConstraintEnabled(true);
+	GetCharacterMovement()->SetPlaneConstraintNormal(FVector(1.0f, 0.0f, 0.0f));
+	GetCharacterMovement()->SetPlaneConstraintOrigin(FVector::ZeroVector);
+	GetCharacterMovement()->bSnapToPlaneAtStart = true;
+
 	// Note: The skeletal mesh and anim blueprint references on the Mesh component (inherited from Character) 
 	// are set in the derived blueprint asset named MyCharacter (to avoid direct content references in C++)
 
@@ -75,11 +90,6 @@ void AGravityCharacter::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
-	// Keep Character locked in X axis at all times
-	FVector ConstrainedLocation = GetActorLocation();
-	ConstrainedLocation.X = 0.0f;
-	SetActorLocation(ConstrainedLocation);
-
 	// Apply gravity to character
 	const FVector OldGravityDir = CachedGravityMovementyCmp->GetGravityDirection();
 	FVector NewGravityDir = GravityPoint - GetActorLocation();
@@ -92,16 +102,7 @@ void AGravityCharacter::Tick(float DeltaTime)
 	//NewGravityDir = FMath::VInterpTo(OldGravityDir, NewGravityDir, DeltaTime, GravityChangeSpeed);
 	CachedGravityMovementyCmp->SetGravityDirection(NewGravityDir);
 
-
-	// Calculate three vector to make the rotation space for camera
-	const FVector ForwardVector{ -1.0f, 0.0f, 0.0f };
-	const FVector UpVector = UKismetMathLibrary::GetDirectionUnitVector(GravityPoint, GetActorLocation());
-	const FVector RightVector = FVector::CrossProduct(UpVector, ForwardVector);
-
-	// Calculate the rotation and set rotation
-	FRotator TargetRotation = UKismetMathLibrary::MakeRotationFromAxes(ForwardVector, RightVector, UpVector);
-	TargetRotation = FMath::RInterpTo(CameraBoom->GetComponentRotation(), TargetRotation, DeltaTime, 15);
-	CameraBoom->SetWorldRotation(TargetRotation);
+	// Camera rotation is handled by CameraRig after physics
 }
 
 void AGravityCharacter::MoveRight(float Val)
@@ -144,6 +145,18 @@ bool AGravityCharacter::GetFlipGravity() const
 }
 
 void AGravityCharacter::SetFlipGravity(bool bNewGravity)
+{
+	UGravitySwapSubsystem* SwapSubsystem = UGravitySwapSubsystem::Get(this);
+	if (SwapSubsystem == nullptr)
+	{
+		ApplyFlipGravity(bNewGravity);
+		return;
+	}
+
+	SwapSubsystem->EnqueueFlip(this, bNewGravity);
+}
+
+void AGravityCharacter::ApplyFlipGravity(bool bNewGravity)
 {
 	bFlipGravity = bNewGravity;
 }
@@ -152,22 +165,7 @@ void AGravityCharacter::AddCollectible(ACollectible* Collectible)
 {
 	if (Collectible != nullptr)
 	{
-		if (Collectible->GetCount() <= 0)
-		{
-			UE_LOG(LogTemp, Error, TEXT("Collitible has invalid count"));
-		}
-
-		if (Collectibles.Contains(Collectible->GetType()))
-		{
-			Collectibles[Collectible->GetType()] += Collectible->GetCount();
-		}
-		else
-		{
-			Collectibles.Add(Collectible->GetType(), Collectible->GetCount());
-		}
-
-		// Notify blueprint 
-		OnCollectibleAdded(Collectible->GetType(), Collectibles[Collectible->GetType()]);
+		AddCollectibles(Collectible->GetType(), Collectible->GetCount());
 	}
 	else
 	{
@@ -175,6 +173,20 @@ void AGravityCharacter::AddCollectible(ACollectible* Collectible)
 	}
 }
 
+void AGravityCharacter::AddCollectibles(ECollectibleType Type, int32 Count)
+{
+	if (Count <= 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Collitible has invalid count"));
+	}
+
+	int32& NewCount = Collectibles.FindOrAdd(Type);
+	NewCount += Count;
+
+	// Notify blueprint 
+	OnCollectibleAdded(Type, NewCount);
+}
+
 void AGravityCharacter::SetGravityTarget(FVector NewGravityPoint)
 {
 	GravityPoint = NewGravityPoint;
@@ -205,7 +217,6 @@ void AGravityCharacter::OnInteractBoxBeginOverlap(UPrimitiveComponent* Overlappe
 	if (ApproachInteractableComp == nullptr) { return; }
 
 	ApproachInteractableComp->ShowInteractionWidget();
-	UE_LOG(LogTemp, Warning, TEXT("Closest Overlap Actor: %s"), *ApproachInteractableComp->GetOwner()->GetName());
 }
 
 void AGravityCharacter::OnInteractBoxEndOverlap(UPrimitiveComponent* OverlappedComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
@@ -221,7 +232,7 @@ void AGravityCharacter::OnApproachInteract()
 	// return if the player is currently jumping or grabbing something
 	if (IsJumping() || IsGrabbing())
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Cannot ApproachInteract while jumping nor grabbing. Calling OnInteractReleased"));
+		INTERACTION_TRACE(ApproachInteract, JumpingOrGrabbing, this, ApproachInteractableComp);
 		OnApproachInteractReleased();
 		return;
 	}
@@ -233,7 +244,7 @@ void AGravityCharacter::OnApproachInteract()
 	// ApproachInteractableComp = TryGetApproachInteractableComp();
 	if (ApproachInteractableComp != nullptr)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Interacts with : %s"), *ApproachInteractableComp->GetName());
+		INTERACTION_TRACE(ApproachInteract, Accepted, this, ApproachInteractableComp);
 		IApproachInteract::Execute_Interact(ApproachInteractableComp);
 	}
 }
@@ -253,7 +264,6 @@ UApproachInteractComponent* AGravityCharacter::TryGetApproachInteractableComp()
 	InteractBox->GetOverlappingActors(OverlappingActors);
 	if (OverlappingActors.Num() == 0)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("OverlappingActors : 0"));
 		return nullptr;
 	}
 
@@ -310,7 +320,7 @@ void AGravityCharacter::OnClickInteract()
 {
 	if (IsJumping() || IsGrabbing())
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Cannot ClickInteract while jumping nor grabbing. Resetting CurrentClickFocus"));
+		INTERACTION_TRACE(ClickInteract, JumpingOrGrabbing, this, nullptr);
 		ResetClickInteract(CurrentClickFocus);
 		return;
 	}
@@ -320,19 +330,18 @@ void AGravityCharacter::OnClickInteract()
 
 	if (Hit.bBlockingHit == false)	// Hit Nothing
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Hit Nothing. Reset CurrentClickFocus"));
+		INTERACTION_TRACE(ClickInteract, HitNothing, this, nullptr);
 		ResetClickInteract(CurrentClickFocus);
 	}
 	else // Hit something
 	{
 		AActor* HitActor = Hit.GetActor();
-		UE_LOG(LogTemp, Warning, TEXT("Clicked: %s"), *HitActor->GetName());
 
 		// Too far to interact
 		if (GetDistanceTo(HitActor) > ClickInteractRange)
 		{
 			//ResetClickInteract(FirstFocus);
-			UE_LOG(LogTemp, Warning, TEXT("Too far to interact! Reset FirstFocus, CurrentClickFocus"));
+			INTERACTION_TRACE(ClickInteract, OutOfRange, this, HitActor);
 			ResetClickInteract(CurrentClickFocus);
 
 			// Debug ClickInteractRange
@@ -344,12 +353,14 @@ void AGravityCharacter::OnClickInteract()
 		UActorComponent* ClickComp = GetComponentByInterface<UClickInteract>(HitActor);
 		if (ClickComp == nullptr)	// This will never happen but still :)
 		{
+			INTERACTION_TRACE(ClickInteract, NotClickInteractable, this, HitActor);
 			ResetClickInteract(CurrentClickFocus);
 			return;
 		}
 		UClickInteractComponent* NewClickFocus = Cast<UClickInteractComponent>(ClickComp);
 		if (NewClickFocus == nullptr) 	// Clicked a Non-ClickInteractable
 		{
+			INTERACTION_TRACE(ClickInteract, NotClickInteractable, this, HitActor);
 			ResetClickInteract(CurrentClickFocus);
 			return;
 		}
@@ -360,11 +371,12 @@ void AGravityCharacter::OnClickInteract()
 				// NewClickFocus is not in player's line of sight
 				if (IsComponentInLineOfSight(NewClickFocus) == false)
 				{
+					INTERACTION_TRACE(ClickInteract, NotInLineOfSight, this, NewClickFocus);
 					ResetClickInteract(CurrentClickFocus);
 					return;
 				}
 
-				UE_LOG(LogTemp, Warning, TEXT("CurrentClickFocus is null. New CurrentClickFocus: %s"), *NewClickFocus->GetName());
+				INTERACTION_TRACE(ClickInteract, NewFocus, this, NewClickFocus);
 				CurrentClickFocus = NewClickFocus;
 				CurrentClickFocus->bSelected = true;
 
@@ -372,49 +384,19 @@ void AGravityCharacter::OnClickInteract()
 
 				// Activate "SwappableHighlight" for objects within range
 				TArray<UClickInteractComponent*> OverlapingComponents = SphereOverlapComponents<UClickInteractComponent>(GetWorld(), GetActorLocation(), ClickInteractRange);
-				for (UClickInteractComponent* OverlapComp : OverlapingComponents)
+				SwapPartnerSolver.Solve(this, CurrentClickFocus, OverlapingComponents);
+				for (UClickInteractComponent* Partner : SwapPartnerSolver.GetPartners())
 				{
-					UE_LOG(LogTemp, Warning, TEXT("Actors within range: %s"), *OverlapComp->GetOwner()->GetName());
-					if (GetDistanceTo(OverlapComp->GetOwner()) < ClickInteractRange)
-					{
-						// one is player and the other is object. but no Relic1
-						if (GetClickFocusType(CurrentClickFocus) == EFocusType::Player && GetClickFocusType(OverlapComp) == EFocusType::Object
-							|| GetClickFocusType(CurrentClickFocus) == EFocusType::Object && GetClickFocusType(OverlapComp) == EFocusType::Player)
-						{
-							if (bHasRelic1 == false)
-							{
-								continue;
-							}
-						}
-
-						// Both are objects. but no Relic2
-						if (GetClickFocusType(CurrentClickFocus) == EFocusType::Object && GetClickFocusType(OverlapComp) == EFocusType::Object)
-						{
-							if (bHasRelic2 == false)
-							{
-								continue;
-							}
-						}
-
-						// Both can't be swapped
-						if (CanSwapGravity(CurrentClickFocus, OverlapComp) == false)
-						{
-							continue;
-						}
-
-						OverlapComp->SwappableHighlight();
-					}
+					Partner->SwappableHighlight();
 				}
 			}
 			else if (CurrentClickFocus == NewClickFocus)	// Clicked the same object
 			{
-				UE_LOG(LogTemp, Warning, TEXT("Clicked the same object. Reset CurrentClickFocus"));
+				INTERACTION_TRACE(ClickInteract, SameFocus, this, NewClickFocus);
 				ResetClickInteract(CurrentClickFocus);
 			}
 			else	// Clicked two different objects
 			{
-				UE_LOG(LogTemp, Warning, TEXT("Clicked two different objects. Reset CurrentClickFocus and NewClickFocus"));
-
 				// Try casting to UGravitySwapComponent
 				UGravitySwapComponent* CurrentClickFocusComp = Cast<UGravitySwapComponent>(GetComponentByInterface<UGravitySwappable>(CurrentClickFocus->GetOwner()));
 				UGravitySwapComponent* NewClickFocusComp = Cast<UGravitySwapComponent>(GetComponentByInterface<UGravitySwappable>(NewClickFocus->GetOwner()));
@@ -422,14 +404,23 @@ void AGravityCharacter::OnClickInteract()
 				// if both has UGravitySwapComponent
 				if (CurrentClickFocusComp != nullptr && NewClickFocusComp != nullptr)
 				{
-					if (CanSwapGravity(CurrentClickFocus, NewClickFocus))
+					// Partners were solved when CurrentClickFocus was selected. Flip state is re-checked in case it changed since
+					if (SwapPartnerSolver.IsPartner(NewClickFocus) && CurrentClickFocusComp->GetPendingFlipGravity() != NewClickFocusComp->GetPendingFlipGravity())
 					{
 						// Flip gravity for both
-						UE_LOG(LogTemp, Warning, TEXT("Swap gravity"));
-						CurrentClickFocusComp->SetFlipGravity(!CurrentClickFocusComp->GetFlipGravity());
-						NewClickFocusComp->SetFlipGravity(!NewClickFocusComp->GetFlipGravity());
+						INTERACTION_TRACE(ClickInteract, Swapped, CurrentClickFocus, NewClickFocus);
+						CurrentClickFocusComp->SetFlipGravity(!CurrentClickFocusComp->GetPendingFlipGravity());
+						NewClickFocusComp->SetFlipGravity(!NewClickFocusComp->GetPendingFlipGravity());
+					}
+					else
+					{
+						INTERACTION_TRACE(ClickInteract, NotSwapPartner, CurrentClickFocus, NewClickFocus);
 					}
 				}
+				else
+				{
+					INTERACTION_TRACE(ClickInteract, NoSwapComponent, CurrentClickFocus, NewClickFocus);
+				}
 
 				ResetClickInteract(CurrentClickFocus);
 				ResetClickInteract(NewClickFocus);
@@ -438,6 +429,22 @@ void AGravityCharacter::OnClickInteract()
 	}
 }
 
+void AGravityCharacter::PreviewSwapWith(UClickInteractComponent* Partner)
+{
+	if (CurrentClickFocus == nullptr || SwapPartnerSolver.IsPartner(Partner) == false) { return; }
+
+	UGravitySwapComponent* FocusSwapComp = FSwapPartnerSolver::GetSwapComponent(CurrentClickFocus);
+	UGravitySwapComponent* PartnerSwapComp = FSwapPartnerSolver::GetSwapComponent(Partner);
+	if (FocusSwapComp == nullptr && PartnerSwapComp == nullptr) { return; }
+
+	SwapPreview->StartPreview(FocusSwapComp, PartnerSwapComp);
+}
+
+void AGravityCharacter::ClearSwapPreview()
+{
+	SwapPreview->ClearPreview();
+}
+
 void AGravityCharacter::ResetClickInteract(UClickInteractComponent*& FocusToReset)
 {
 	if (FocusToReset == nullptr) { return; }
@@ -445,6 +452,8 @@ void AGravityCharacter::ResetClickInteract(UClickInteractComponent*& FocusToRese
 
 	FocusToReset->OnReset();
 	FocusToReset = nullptr;
+	SwapPartnerSolver.Reset();
+	ClearSwapPreview();
 
 	// Reset all clickable objects within range
 	TArray<UClickInteractComponent*> OverlapingComponents = SphereOverlapComponents<UClickInteractComponent>(GetWorld(), GetActorLocation(), ClickInteractRange);
@@ -452,7 +461,7 @@ void AGravityCharacter::ResetClickInteract(UClickInteractComponent*& FocusToRese
 	{
 		if (GetDistanceTo(Comp->GetOwner()) < ClickInteractRange)
 		{
-			UE_LOG(LogTemp, Warning, TEXT("ClickComp Reset: %s"), *Comp->GetOwner()->GetName());
+			INTERACTION_TRACE(ClickReset, None, this, Comp);
 			Comp->OnReset();
 		}
 	}
@@ -476,7 +485,7 @@ bool AGravityCharacter::CanSwapGravity(UActorComponent* Comp1, UActorComponent*
 	// One of the focuses is player but does not have Relic1 power.
 	if (bHasRelic1 == false && bIsFocusPlayer == true)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Can't swap gravity! : Player does not have a Relic1 power"));
+		INTERACTION_TRACE(CanSwapGravity, NoRelic1, Comp1, Comp2);
 		ResetClickInteract(CurrentClickFocus);
 		return false;
 	}
@@ -484,7 +493,7 @@ bool AGravityCharacter::CanSwapGravity(UActorComponent* Comp1, UActorComponent*
 	// both focuses are object but does not have Relic2 power
 	if (bHasRelic2 == false && bIsFocusPlayer == false)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Can't swap gravity! : Player does not have a Relic2 power"));
+		INTERACTION_TRACE(CanSwapGravity, NoRelic2, Comp1, Comp2);
 		ResetClickInteract(CurrentClickFocus);
 		return false;
 	}
@@ -496,21 +505,21 @@ bool AGravityCharacter::CanSwapGravity(UActorComponent* Comp1, UActorComponent*
 	// if one of them doesn't have UGravitySwapComponent
 	if (GravityComp1 == nullptr || GravityComp2 == nullptr)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Can't swap gravity! : One or both object don't have UGravitySwapComponent"));
+		INTERACTION_TRACE(CanSwapGravity, NoSwapComponent, Comp1, Comp2);
 		return false;
 	}
 
 	// if both has same gravity direction
 	if (GravityComp1->GetFlipGravity() == GravityComp2->GetFlipGravity())
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Can't swap gravity! : Both has same gravity direction"));
+		INTERACTION_TRACE(CanSwapGravity, SameGravity, Comp1, Comp2);
 		return false;
 	}
 
 	// if one of them is not in player's line of sight
 	if (!IsComponentInLineOfSight(Comp1) || !IsComponentInLineOfSight(Comp2))
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Can't swap gravity! : One of them is not in player's line of sight"));
+		INTERACTION_TRACE(CanSwapGravity, NotInLineOfSight, Comp1, Comp2);
 		return false;
 	}
 
@@ -11,6 +11,7 @@
 #include "Collectible.h"
 #include "Enums.h"
 #include "ApproachInteractComponent.h"
+#include "SwapPartnerSolver.h"
 #include "GravityCharacter.generated.h"
 
 template<class T>
@@ -56,6 +57,9 @@ class GP2_TEAM5_API AGravityCharacter : public ACharacter, public IGravitySwappa
 {
 	GENERATED_BODY()
 
+	friend class UGravitySnapshotSubsystem;
+	friend class USaveGameSubsystem;
+	friend class UCheckpointSubsystem;
 
 public:
 	// Sets default values for this character's properties
@@ -64,8 +68,10 @@ public:
 	// IGravitySwappable
 	virtual bool GetFlipGravity() const override;
 	virtual void SetFlipGravity(bool bNewGravity) override;
+	virtual void ApplyFlipGravity(bool bNewGravity) override;
 
 	virtual void AddCollectible(ACollectible* Collectible);
+	void AddCollectibles(ECollectibleType Type, int32 Count);
 
 protected: 
 	virtual void BeginPlay() override;
@@ -85,6 +91,9 @@ protected:
 	FORCEINLINE class UCameraComponent* GetSideViewCameraComponent() const { return SideViewCameraComponent; }
 	FORCEINLINE class USpringArmComponent* GetCameraBoom() const { return CameraBoom; }
 
+public:
+	FVector GetGravityPoint() const { return GravityPoint; }
+
 // -- Member variables --
 protected:
 	UPROPERTY(SaveGame, BlueprintReadWrite, Category = "GravityCharacter|SaveData")
@@ -111,6 +120,14 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera)
 	class USpringArmComponent* CameraBoom;
 
+	/* Rotates CameraBoom to follow the gravity point */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera)
+	class UGravityCameraRigComponent* CameraRig;
+
+	/* Predicts where the focused body and a hovered swap partner go if swapped */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "GravityCharacter|Interaction")
+	class USwapTrajectoryPreviewComponent* SwapPreview;
+
 #pragma region Jump
 
 	void Jump();
@@ -147,21 +164,27 @@ protected:
 	UClickInteractComponent* CurrentClickFocus = nullptr;
 	void ResetClickInteract(UClickInteractComponent*& FocusToReset);
 
+	// Components CurrentClickFocus can swap gravity with. Solved once when the focus is selected
+	FSwapPartnerSolver SwapPartnerSolver;
+
 	// Grab
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GravityCharacter|Interaction")
 	UApproachInteractComponent* CurrentGrabbingBox = nullptr;
 
 	// Powers
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GravityCharacter|Interaction")
+	UPROPERTY(EditAnywhere, SaveGame, BlueprintReadWrite, Category = "GravityCharacter|Interaction")
 	bool bHasRelic1 = false;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GravityCharacter|Interaction")
+	UPROPERTY(EditAnywhere, SaveGame, BlueprintReadWrite, Category = "GravityCharacter|Interaction")
 	bool bHasRelic2 = false;
 
 public:
 	bool CanSwapGravity(UActorComponent* Comp1, UActorComponent* Comp2);
 	float GetClickInteractRange() { return ClickInteractRange; }
 	UClickInteractComponent* GetCurrentClickFocus() { return CurrentClickFocus; }
+	const FSwapPartnerSolver& GetSwapPartners() const { return SwapPartnerSolver; }
+	void PreviewSwapWith(UClickInteractComponent* Partner);
+	void ClearSwapPreview();
 	EFocusType GetClickFocusType(UClickInteractComponent* ClickFocus);
 	bool IsComponentInLineOfSight(UActorComponent* Comp);
 
@@ -72,7 +72,8 @@ FVector UGravityMovementComponent::GetGravityDirection(bool bAvoidZeroGravity) c
 
 void UGravityMovementComponent::SetGravityDirection(FVector NewGravityDirection)
 {
-	CustomGravityDirection = NewGravityDirection.GetSafeNormal();
+	// Projected onto the constraint plane, so a gravity point outside the plane can't pull the character off it
+	CustomGravityDirection = ConstrainDirectionToPlane(NewGravityDirection).GetSafeNormal();
 }
 
 void UGravityMovementComponent::PhysFlying(float deltaTime, int32 Iterations)
@@ -976,7 +977,7 @@ FVector UGravityMovementComponent::ConstrainInputAcceleration(const FVector& Inp
 		NewAccel = FVector::VectorPlaneProject(NewAccel, GetCapsuleAxisZ());
 	}
 
-	return NewAccel;
+	return ConstrainDirectionToPlane(NewAccel);
 }
 
 FVector UGravityMovementComponent::ScaleInputAcceleration(const FVector& InputAcceleration) const
@@ -2323,6 +2324,9 @@ void UGravityMovementComponent::StartNewPhysics(float deltaTime, int32 Iteration
 
 	bMovementInProgress = true;
 
+	// Keep velocity in the constraint plane. Sweep deltas are projected by MoveUpdatedComponent
+	Velocity = ConstrainDirectionToPlane(Velocity);
+
 	switch (MovementMode)
 	{
 	case MOVE_None:
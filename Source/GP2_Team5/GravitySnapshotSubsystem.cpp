@@ -0,0 +1,218 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GravitySnapshotSubsystem.h"
+#include "Engine/World.h"
+#include "Kismet/GameplayStatics.h"
+#include "Components/PrimitiveComponent.h"
+#include "GravitySwapComponent.h"
+#include "GravitySwapSubsystem.h"
+#include "GravityApplicatorSubsystem.h"
+#include "GravityCharacter.h"
+#include "GravityMovementComponent.h"
+
+void UGravitySnapshotSubsystem::Deinitialize()
+{
+	for (UGravitySwapComponent* Comp : Bodies)
+	{
+		Comp->SnapshotIndex = INDEX_NONE;
+	}
+	Bodies.Reset();
+
+	Super::Deinitialize();
+}
+
+UGravitySnapshotSubsystem* UGravitySnapshotSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject != nullptr ? WorldContextObject->GetWorld() : nullptr;
+	if (World == nullptr || World->IsGameWorld() == false) { return nullptr; }
+
+	return World->GetSubsystem<UGravitySnapshotSubsystem>();
+}
+
+void UGravitySnapshotSubsystem::Register(UGravitySwapComponent* Comp)
+{
+	if (Comp == nullptr || Comp->SnapshotIndex != INDEX_NONE) { return; }
+
+	Comp->SnapshotIndex = Bodies.Add(Comp);
+}
+
+void UGravitySnapshotSubsystem::Unregister(UGravitySwapComponent* Comp)
+{
+	if (Comp == nullptr || Bodies.IsValidIndex(Comp->SnapshotIndex) == false) { return; }
+
+	const int32 Index = Comp->SnapshotIndex;
+	Comp->SnapshotIndex = INDEX_NONE;
+	Bodies.RemoveAtSwap(Index, 1, false);
+
+	// The last entry moved into the freed slot
+	if (Bodies.IsValidIndex(Index))
+	{
+		Bodies[Index]->SnapshotIndex = Index;
+	}
+}
+
+FGravitySnapshot UGravitySnapshotSubsystem::CaptureSnapshot() const
+{
+	FGravitySnapshot Snapshot;
+
+	AGravityCharacter* Player = Cast<AGravityCharacter>(UGameplayStatics::GetPlayerPawn(this, 0));
+	const int32 PlayerSize = Player != nullptr ? sizeof(FGravityPlayerRecord) : 0;
+
+	// One allocation for the whole buffer, records are written in place
+	Snapshot.Data.AddUninitialized(PlayerSize + Bodies.Num() * sizeof(FGravityBodyRecord));
+	uint8* Cursor = Snapshot.Data.GetData();
+
+	if (Player != nullptr)
+	{
+		Snapshot.Player = Player;
+		WritePlayer(Player, *reinterpret_cast<FGravityPlayerRecord*>(Cursor));
+		Cursor += sizeof(FGravityPlayerRecord);
+	}
+
+	Snapshot.Bodies.Reserve(Bodies.Num());
+	for (const UGravitySwapComponent* Comp : Bodies)
+	{
+		Snapshot.Bodies.Add(const_cast<UGravitySwapComponent*>(Comp));
+		WriteBody(Comp, *reinterpret_cast<FGravityBodyRecord*>(Cursor));
+		Cursor += sizeof(FGravityBodyRecord);
+	}
+
+	if (UGravitySwapSubsystem* SwapSubsystem = UGravitySwapSubsystem::Get(this))
+	{
+		Snapshot.UndoMark = SwapSubsystem->GetUndoMark();
+	}
+	return Snapshot;
+}
+
+void UGravitySnapshotSubsystem::RestoreSnapshot(const FGravitySnapshot& Snapshot)
+{
+	if (Snapshot.IsValid() == false) { return; }
+
+	const int32 PlayerSize = Snapshot.Player.IsExplicitlyNull() ? 0 : sizeof(FGravityPlayerRecord);
+	if (Snapshot.Data.Num() != PlayerSize + Snapshot.Bodies.Num() * sizeof(FGravityBodyRecord)) { return; }
+
+	// Flips restored here replace whatever was queued or logged after the capture
+	if (UGravitySwapSubsystem* SwapSubsystem = UGravitySwapSubsystem::Get(this))
+	{
+		SwapSubsystem->DiscardAfterMark(Snapshot.UndoMark);
+	}
+
+	const uint8* Cursor = Snapshot.Data.GetData();
+	TArray<IGravitySwappable*, TInlineAllocator<16>> Changed;
+
+	if (PlayerSize > 0)
+	{
+		const FGravityPlayerRecord& Record = *reinterpret_cast<const FGravityPlayerRecord*>(Cursor);
+		if (AGravityCharacter* Player = Snapshot.Player.Get())
+		{
+			if (Player->GetFlipGravity() != (Record.bFlipGravity != 0))
+			{
+				Changed.Add(Player);
+			}
+			ReadPlayer(Player, Record);
+		}
+		Cursor += sizeof(FGravityPlayerRecord);
+	}
+
+	for (const TWeakObjectPtr<UGravitySwapComponent>& Body : Snapshot.Bodies)
+	{
+		const FGravityBodyRecord& Record = *reinterpret_cast<const FGravityBodyRecord*>(Cursor);
+		Cursor += sizeof(FGravityBodyRecord);
+
+		// Destroyed or pooled since the capture
+		UGravitySwapComponent* Comp = Body.Get();
+		if (Comp == nullptr || Comp->SnapshotIndex == INDEX_NONE) { continue; }
+
+		if (Comp->GetFlipGravity() != (Record.bFlipGravity != 0))
+		{
+			Changed.Add(Comp);
+		}
+		ReadBody(Comp, Record);
+	}
+
+	// Same batching as a swap flush, listeners see the fully restored state
+	for (IGravitySwappable* Swappable : Changed)
+	{
+		Swappable->NotifyFlipGravity();
+	}
+}
+
+void UGravitySnapshotSubsystem::WriteBody(const UGravitySwapComponent* Comp, FGravityBodyRecord& Record) const
+{
+	const UPrimitiveComponent* PhysicsComp = Comp->GetPhysicsComp();
+	const FTransform Transform = PhysicsComp != nullptr ? PhysicsComp->GetComponentTransform() : Comp->GetOwner()->GetActorTransform();
+
+	Record.Location = Transform.GetLocation();
+	Record.Rotation = Transform.GetRotation();
+	Record.LinearVelocity = PhysicsComp != nullptr ? PhysicsComp->GetPhysicsLinearVelocity() : FVector::ZeroVector;
+	Record.AngularVelocity = PhysicsComp != nullptr ? PhysicsComp->GetPhysicsAngularVelocityInRadians() : FVector::ZeroVector;
+	Record.bFlipGravity = Comp->GetFlipGravity();
+	Record.bSimulating = PhysicsComp != nullptr && PhysicsComp->IsSimulatingPhysics();
+	Record.bAwake = PhysicsComp != nullptr && PhysicsComp->RigidBodyIsAwake();
+
+	// A kinematic LOD body is simulated as far as gameplay is concerned
+	UGravityApplicatorSubsystem* Applicator = UGravityApplicatorSubsystem::Get(Comp);
+	if (Applicator != nullptr && Applicator->IsKinematicLOD(Comp))
+	{
+		Record.LinearVelocity = Applicator->GetLODVelocity(Comp);
+		Record.bSimulating = true;
+		Record.bAwake = true;
+	}
+}
+
+void UGravitySnapshotSubsystem::ReadBody(UGravitySwapComponent* Comp, const FGravityBodyRecord& Record)
+{
+	Comp->ApplyFlipGravity(Record.bFlipGravity != 0);
+
+	UPrimitiveComponent* PhysicsComp = Comp->GetPhysicsComp();
+	if (PhysicsComp == nullptr)
+	{
+		Comp->GetOwner()->SetActorLocationAndRotation(Record.Location, Record.Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+		return;
+	}
+
+	if (PhysicsComp->IsSimulatingPhysics() != (Record.bSimulating != 0))
+	{
+		PhysicsComp->SetSimulatePhysics(Record.bSimulating != 0);
+	}
+
+	PhysicsComp->SetWorldLocationAndRotation(Record.Location, Record.Rotation, false, nullptr, ETeleportType::ResetPhysics);
+	if (Record.bSimulating == 0) { return; }
+
+	PhysicsComp->SetPhysicsLinearVelocity(Record.LinearVelocity);
+	PhysicsComp->SetPhysicsAngularVelocityInRadians(Record.AngularVelocity);
+	if (Record.bAwake)
+	{
+		PhysicsComp->WakeRigidBody();
+	}
+	else
+	{
+		PhysicsComp->PutRigidBodyToSleep();
+	}
+}
+
+void UGravitySnapshotSubsystem::WritePlayer(const AGravityCharacter* Player, FGravityPlayerRecord& Record) const
+{
+	const UGravityMovementComponent* Movement = Player->CachedGravityMovementyCmp;
+
+	Record.Location = Player->GetActorLocation();
+	Record.Rotation = Player->GetActorQuat();
+	Record.Velocity = Movement != nullptr ? Movement->Velocity : FVector::ZeroVector;
+	Record.GravityPoint = Player->GravityPoint;
+	Record.bFlipGravity = Player->GetFlipGravity();
+	Record.MovementMode = Movement != nullptr ? Movement->MovementMode.GetValue() : MOVE_None;
+}
+
+void UGravitySnapshotSubsystem::ReadPlayer(AGravityCharacter* Player, const FGravityPlayerRecord& Record)
+{
+	Player->ApplyFlipGravity(Record.bFlipGravity != 0);
+	Player->SetGravityTarget(Record.GravityPoint);
+	Player->SetActorLocationAndRotation(Record.Location, Record.Rotation, false, nullptr, ETeleportType::ResetPhysics);
+
+	if (UGravityMovementComponent* Movement = Player->CachedGravityMovementyCmp)
+	{
+		Movement->Velocity = Record.Velocity;
+		Movement->SetMovementMode(static_cast<EMovementMode>(Record.MovementMode));
+	}
+}
@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GravitySnapshotSubsystem.generated.h"
+
+//--- forward declarations ---
+class UGravitySwapComponent;
+class AGravityCharacter;
+
+// Fixed size record of one swappable body, stored back to back in FGravitySnapshot::Data
+struct FGravityBodyRecord
+{
+	FVector Location;
+	FQuat Rotation;
+	FVector LinearVelocity;
+	FVector AngularVelocity;
+	uint8 bFlipGravity;
+	uint8 bSimulating;
+	uint8 bAwake;
+};
+
+struct FGravityPlayerRecord
+{
+	FVector Location;
+	FQuat Rotation;
+	FVector Velocity;
+	FVector GravityPoint;
+	uint8 bFlipGravity;
+	uint8 MovementMode;
+};
+
+USTRUCT(BlueprintType)
+struct FGravitySnapshot
+{
+	GENERATED_BODY()
+
+	// FGravityPlayerRecord (when HasPlayer) followed by one FGravityBodyRecord per entry in Bodies
+	TArray<uint8> Data;
+
+	TArray<TWeakObjectPtr<UGravitySwapComponent>> Bodies;
+	TWeakObjectPtr<AGravityCharacter> Player;
+
+	// UGravitySwapSubsystem undo mark at capture time
+	int32 UndoMark = 0;
+
+	bool IsValid() const { return Data.Num() > 0; }
+};
+
+/**
+ * Captures the physics and gravity state of every swappable body and the player into one binary buffer,
+ * and writes it back in place. Puzzle retries restore a snapshot instead of respawning actors or reloading the level.
+ * Fractured destructibles only restore their root body.
+ */
+UCLASS()
+class GP2_TEAM5_API UGravitySnapshotSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	static UGravitySnapshotSubsystem* Get(const UObject* WorldContextObject);
+
+	void Register(UGravitySwapComponent* Comp);
+	void Unregister(UGravitySwapComponent* Comp);
+
+	UFUNCTION(BlueprintCallable, Category = "Gravity|Snapshot")
+	FGravitySnapshot CaptureSnapshot() const;
+
+	UFUNCTION(BlueprintCallable, Category = "Gravity|Snapshot")
+	void RestoreSnapshot(const FGravitySnapshot& Snapshot);
+
+	UFUNCTION(BlueprintPure, Category = "Gravity|Snapshot")
+	int32 GetNumBodies() const { return Bodies.Num(); }
+
+	// Every swappable body in the world that isn't pooled
+	const TArray<UGravitySwapComponent*>& GetBodies() const { return Bodies; }
+
+protected:
+	void WriteBody(const UGravitySwapComponent* Comp, FGravityBodyRecord& Record) const;
+	void ReadBody(UGravitySwapComponent* Comp, const FGravityBodyRecord& Record);
+	void WritePlayer(const AGravityCharacter* Player, FGravityPlayerRecord& Record) const;
+	void ReadPlayer(AGravityCharacter* Player, const FGravityPlayerRecord& Record);
+
+	TArray<UGravitySwapComponent*> Bodies;
+};
@@ -2,6 +2,10 @@
 
 #include "GravitySwapComponent.h"
 #include "Kismet/KismetMathLibrary.h"
+#include "GravitySwapSubsystem.h"
+#include "GravityApplicatorSubsystem.h"
+#include "GravitySwapPoolSubsystem.h"
+#include "GravitySnapshotSubsystem.h"
 #include <../Plugins/Runtime/ApexDestruction/Source/ApexDestruction/Public/DestructibleComponent.h>
 
 // Sets default values for this component's properties
@@ -16,23 +20,111 @@ void UGravitySwapComponent::BeginPlay()
 	SetComponentTickEnabled(bCanEverTick);
 	Super::BeginPlay();
 
+	UGravitySwapPoolSubsystem* Pool = UGravitySwapPoolSubsystem::Get(this);
+	PhysicsComp = Pool != nullptr ? Pool->ResolvePhysicsComp(this) : FindPhysicsComponent();
+	bInitialFlipGravity = bFlipGravity;
+
+	RegisterWithApplicator();
+
+	if (UGravitySnapshotSubsystem* Snapshots = UGravitySnapshotSubsystem::Get(this))
+	{
+		Snapshots->Register(this);
+	}
+}
+
+void UGravitySwapComponent::RegisterWithApplicator()
+{
+	// Gravity is applied from the physics step when possible. Ticking is the fallback
+	if (bCanEverTick && bUseSubstepGravity)
+	{
+		UGravityApplicatorSubsystem* Applicator = UGravityApplicatorSubsystem::Get(this);
+		if (Applicator != nullptr && Applicator->Register(this))
+		{
+			SetComponentTickEnabled(false);
+		}
+	}
+}
+
+void UGravitySwapComponent::OnReleasedToPool()
+{
+	if (UGravityApplicatorSubsystem* Applicator = UGravityApplicatorSubsystem::Get(this))
+	{
+		Applicator->Unregister(this);
+	}
+	if (UGravitySnapshotSubsystem* Snapshots = UGravitySnapshotSubsystem::Get(this))
+	{
+		Snapshots->Unregister(this);
+	}
+	SetComponentTickEnabled(false);
+
+	if (PhysicsComp != nullptr)
+	{
+		bSimulatedBeforePool = PhysicsComp->IsSimulatingPhysics();
+		PhysicsComp->SetSimulatePhysics(false);
+	}
+}
+
+void UGravitySwapComponent::OnAcquiredFromPool()
+{
+	// A fractured destructible gets a fresh, unfractured physics actor
+	if (UDestructibleComponent* Destructible = Cast<UDestructibleComponent>(PhysicsComp))
+	{
+		Destructible->RecreatePhysicsState();
+	}
+
+	if (PhysicsComp != nullptr)
+	{
+		PhysicsComp->SetSimulatePhysics(bSimulatedBeforePool);
+		PhysicsComp->SetPhysicsLinearVelocity(FVector::ZeroVector);
+		PhysicsComp->SetPhysicsAngularVelocityInDegrees(FVector::ZeroVector);
+	}
+
+	if (bFlipGravity != bInitialFlipGravity)
+	{
+		ApplyFlipGravity(bInitialFlipGravity);
+		NotifyFlipGravity();
+	}
+
+	SetComponentTickEnabled(bCanEverTick);
+	RegisterWithApplicator();
+
+	if (UGravitySnapshotSubsystem* Snapshots = UGravitySnapshotSubsystem::Get(this))
+	{
+		Snapshots->Register(this);
+	}
+}
+
+void UGravitySwapComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UGravityApplicatorSubsystem* Applicator = UGravityApplicatorSubsystem::Get(this))
+	{
+		Applicator->Unregister(this);
+	}
+	if (UGravitySnapshotSubsystem* Snapshots = UGravitySnapshotSubsystem::Get(this))
+	{
+		Snapshots->Unregister(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+UPrimitiveComponent* UGravitySwapComponent::FindPhysicsComponent() const
+{
 	TArray<UStaticMeshComponent*> Components;
 	GetOwner()->GetComponents<UStaticMeshComponent>(Components);
 	for (int32 i = 0; i < Components.Num(); i++)
 	{
-		PhysicsComp = Components[i];
-		return;
+		return Components[i];
 	}
 
 	TArray<UDestructibleComponent*> DestructibleComponents;
 	GetOwner()->GetComponents<UDestructibleComponent>(DestructibleComponents);
 	for (int32 i = 0; i < DestructibleComponents.Num(); i++)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Found a destructible"));
-		PhysicsComp = DestructibleComponents[i];
-		return;
+		return DestructibleComponents[i];
 	}
 
+	return nullptr;
 }
 
 // Called every frame
@@ -66,7 +158,39 @@ bool UGravitySwapComponent::GetFlipGravity() const
 
 
 void UGravitySwapComponent::SetFlipGravity(bool bNewGravity)
+{
+	UGravitySwapSubsystem* SwapSubsystem = UGravitySwapSubsystem::Get(this);
+	if (SwapSubsystem == nullptr)
+	{
+		ApplyFlipGravity(bNewGravity);
+		NotifyFlipGravity();
+		return;
+	}
+
+	SwapSubsystem->EnqueueFlip(this, bNewGravity);
+}
+
+void UGravitySwapComponent::ApplyFlipGravity(bool bNewGravity)
 {
 	bFlipGravity = bNewGravity;
-	OnFlipGravity.Broadcast(bNewGravity);
+
+	if (UGravityApplicatorSubsystem* Applicator = UGravityApplicatorSubsystem::Get(this))
+	{
+		Applicator->SetFlipGravity(this, bFlipGravity);
+	}
+}
+
+void UGravitySwapComponent::SetGravityPoint(FVector NewGravityPoint)
+{
+	GravityPoint = NewGravityPoint;
+
+	if (UGravityApplicatorSubsystem* Applicator = UGravityApplicatorSubsystem::Get(this))
+	{
+		Applicator->SetGravityPoint(this, GravityPoint);
+	}
+}
+
+void UGravitySwapComponent::NotifyFlipGravity()
+{
+	OnFlipGravity.Broadcast(bFlipGravity);
 }
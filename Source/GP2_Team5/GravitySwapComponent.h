@@ -20,6 +20,7 @@ public:
 protected:
 	// Called when the game starts
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:
 	// Called every frame
@@ -33,8 +34,26 @@ public:
 
 	virtual bool GetFlipGravity() const override;
 	virtual void SetFlipGravity(bool bNewGravity) override;
+	virtual void ApplyFlipGravity(bool bNewGravity) override;
+	virtual void NotifyFlipGravity() override;
+
+	UFUNCTION(BlueprintCallable, Category = "Gravity")
+	void SetGravityPoint(FVector NewGravityPoint);
+
+	FVector GetGravityPoint() const { return GravityPoint; }
+	float GetGravityAcceleration() const { return GravityAcceleration; }
+	UPrimitiveComponent* GetPhysicsComp() const { return PhysicsComp; }
+	UPrimitiveComponent* FindPhysicsComponent() const;
+
+	// Called by UGravitySwapPoolSubsystem when the owner is pooled and reused
+	void OnReleasedToPool();
+	void OnAcquiredFromPool();
 
 protected:
+	friend class UGravityApplicatorSubsystem;
+	friend class UGravitySnapshotSubsystem;
+
+	void RegisterWithApplicator();
 
 	UPROPERTY(EditAnywhere, Category = "Gravity")
 	FVector GravityPoint {};
@@ -48,6 +67,29 @@ protected:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Mesh")
 	class UPrimitiveComponent* PhysicsComp = nullptr;
 
+	/* Acceleration towards GravityPoint in cm/s^2. Independent of mass and frame rate when applied from the physics step */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Gravity");
 	float GravityAcceleration = 1400.F;
+
+	/* Apply gravity from UGravityApplicatorSubsystem's physics step callback instead of ticking this component */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Gravity")
+	bool bUseSubstepGravity = true;
+
+	/* Stop keeping the body awake once it rests, so the physics engine can put it to sleep. A flip, a contact or a gravity point change wakes it */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Gravity")
+	bool bAllowSleep = true;
+
+	/* Let UGravityApplicatorSubsystem switch this body to kinematic while it is far from the player and falling straight */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Gravity")
+	bool bAllowKinematicLOD = true;
+
+	// State restored when the owner is reused from the pool
+	bool bInitialFlipGravity = false;
+	bool bSimulatedBeforePool = false;
+
+	// Slot in UGravityApplicatorSubsystem, INDEX_NONE when this component ticks itself
+	int32 ApplicatorIndex = INDEX_NONE;
+
+	// Slot in UGravitySnapshotSubsystem, INDEX_NONE while pooled
+	int32 SnapshotIndex = INDEX_NONE;
 };
@@ -0,0 +1,135 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GravitySwapPoolSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "GravitySwapComponent.h"
+
+void UGravitySwapPoolSubsystem::Deinitialize()
+{
+	Pools.Reset();
+	PhysicsCompNames.Reset();
+
+	Super::Deinitialize();
+}
+
+UGravitySwapPoolSubsystem* UGravitySwapPoolSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject != nullptr ? WorldContextObject->GetWorld() : nullptr;
+	if (World == nullptr || World->IsGameWorld() == false) { return nullptr; }
+
+	return World->GetSubsystem<UGravitySwapPoolSubsystem>();
+}
+
+void UGravitySwapPoolSubsystem::Prewarm(TSubclassOf<AActor> ActorClass, int32 Count)
+{
+	if (ActorClass == nullptr) { return; }
+
+	FGravitySwapPoolEntry& Pool = Pools.FindOrAdd(ActorClass);
+	Pool.FreeActors.Reserve(Pool.FreeActors.Num() + Count);
+	for (int32 i = 0; i < Count; i++)
+	{
+		AActor* Actor = SpawnPooledActor(ActorClass, FTransform(PoolLocation));
+		if (Actor == nullptr) { return; }
+
+		Deactivate(Actor);
+		Pool.FreeActors.Add(Actor);
+	}
+}
+
+AActor* UGravitySwapPoolSubsystem::AcquireActor(TSubclassOf<AActor> ActorClass, const FTransform& Transform)
+{
+	if (ActorClass == nullptr) { return nullptr; }
+
+	if (FGravitySwapPoolEntry* Pool = Pools.Find(ActorClass))
+	{
+		while (Pool->FreeActors.Num() > 0)
+		{
+			AActor* Actor = Pool->FreeActors.Pop(false);
+			if (IsValid(Actor))
+			{
+				Activate(Actor, Transform);
+				return Actor;
+			}
+		}
+	}
+
+	return SpawnPooledActor(ActorClass, Transform);
+}
+
+void UGravitySwapPoolSubsystem::ReleaseActor(AActor* Actor)
+{
+	if (IsValid(Actor) == false) { return; }
+
+	FGravitySwapPoolEntry& Pool = Pools.FindOrAdd(Actor->GetClass());
+	if (Pool.FreeActors.Contains(Actor)) { return; }
+
+	Deactivate(Actor);
+	Pool.FreeActors.Add(Actor);
+}
+
+int32 UGravitySwapPoolSubsystem::GetNumFree(TSubclassOf<AActor> ActorClass) const
+{
+	const FGravitySwapPoolEntry* Pool = Pools.Find(ActorClass);
+	return Pool != nullptr ? Pool->FreeActors.Num() : 0;
+}
+
+UPrimitiveComponent* UGravitySwapPoolSubsystem::ResolvePhysicsComp(const UGravitySwapComponent* SwapComp)
+{
+	AActor* Owner = SwapComp != nullptr ? SwapComp->GetOwner() : nullptr;
+	if (Owner == nullptr) { return nullptr; }
+
+	// Components of the same class keep their names, so a name lookup replaces the component scan
+	if (const FName* CachedName = PhysicsCompNames.Find(Owner->GetClass()))
+	{
+		if (UPrimitiveComponent* Cached = FindObjectFast<UPrimitiveComponent>(Owner, *CachedName))
+		{
+			return Cached;
+		}
+	}
+
+	UPrimitiveComponent* Found = SwapComp->FindPhysicsComponent();
+	if (Found != nullptr)
+	{
+		PhysicsCompNames.Add(Owner->GetClass(), Found->GetFName());
+	}
+	return Found;
+}
+
+AActor* UGravitySwapPoolSubsystem::SpawnPooledActor(UClass* ActorClass, const FTransform& Transform)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	return GetWorld()->SpawnActor<AActor>(ActorClass, Transform, SpawnParams);
+}
+
+void UGravitySwapPoolSubsystem::Deactivate(AActor* Actor)
+{
+	TArray<UGravitySwapComponent*> SwapComps;
+	Actor->GetComponents<UGravitySwapComponent>(SwapComps);
+	for (UGravitySwapComponent* SwapComp : SwapComps)
+	{
+		SwapComp->OnReleasedToPool();
+	}
+
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorTickEnabled(false);
+	Actor->SetActorLocation(PoolLocation, false, nullptr, ETeleportType::ResetPhysics);
+}
+
+void UGravitySwapPoolSubsystem::Activate(AActor* Actor, const FTransform& Transform)
+{
+	Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+	Actor->SetActorHiddenInGame(false);
+	Actor->SetActorEnableCollision(true);
+	Actor->SetActorTickEnabled(Actor->PrimaryActorTick.bStartWithTickEnabled);
+
+	TArray<UGravitySwapComponent*> SwapComps;
+	Actor->GetComponents<UGravitySwapComponent>(SwapComps);
+	for (UGravitySwapComponent* SwapComp : SwapComps)
+	{
+		SwapComp->OnAcquiredFromPool();
+	}
+}
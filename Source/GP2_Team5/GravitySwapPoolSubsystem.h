@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GravitySwapPoolSubsystem.generated.h"
+
+//--- forward declarations ---
+class UGravitySwapComponent;
+
+USTRUCT()
+struct FGravitySwapPoolEntry
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<AActor*> FreeActors;
+};
+
+/**
+ * Pool for gravity swappable props (push boxes, destructibles) that puzzles spawn and remove.
+ * Released actors are hidden and taken out of the simulation instead of destroyed, and get their
+ * physics and flip state reset when acquired again.
+ * Also caches which component a swappable class uses as its physics body, so spawning doesn't rescan components.
+ */
+UCLASS()
+class GP2_TEAM5_API UGravitySwapPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	static UGravitySwapPoolSubsystem* Get(const UObject* WorldContextObject);
+
+	// Spawns Count inactive instances of ActorClass ahead of time
+	UFUNCTION(BlueprintCallable, Category = "Gravity|Pool")
+	void Prewarm(TSubclassOf<AActor> ActorClass, int32 Count);
+
+	// Takes an instance from the pool, or spawns one if the pool is empty
+	UFUNCTION(BlueprintCallable, Category = "Gravity|Pool", meta = (DeterminesOutputType = "ActorClass"))
+	AActor* AcquireActor(TSubclassOf<AActor> ActorClass, const FTransform& Transform);
+
+	// Returns the actor to the pool. Use instead of DestroyActor
+	UFUNCTION(BlueprintCallable, Category = "Gravity|Pool")
+	void ReleaseActor(AActor* Actor);
+
+	UFUNCTION(BlueprintPure, Category = "Gravity|Pool")
+	int32 GetNumFree(TSubclassOf<AActor> ActorClass) const;
+
+	// Physics body of SwapComp's owner, resolved once per class
+	UPrimitiveComponent* ResolvePhysicsComp(const UGravitySwapComponent* SwapComp);
+
+protected:
+	AActor* SpawnPooledActor(UClass* ActorClass, const FTransform& Transform);
+	void Deactivate(AActor* Actor);
+	void Activate(AActor* Actor, const FTransform& Transform);
+
+	UPROPERTY()
+	TMap<UClass*, FGravitySwapPoolEntry> Pools;
+
+	TMap<TWeakObjectPtr<UClass>, FName> PhysicsCompNames;
+
+	// Where prewarmed instances wait until they are acquired
+	FVector PoolLocation { 0.f, 0.f, -100000.f };
+};
@@ -0,0 +1,247 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GravitySwapSubsystem.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "Kismet/GameplayStatics.h"
+#include "GravitySwappable.h"
+
+void FGravitySwapTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Subsystem != nullptr)
+	{
+		Subsystem->Flush();
+	}
+}
+
+FString FGravitySwapTickFunction::DiagnosticMessage()
+{
+	return TEXT("UGravitySwapSubsystem::Flush");
+}
+
+void UGravitySwapSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	TickFunction.bCanEverTick = true;
+	TickFunction.bStartWithTickEnabled = true;
+	TickFunction.TickGroup = TG_PrePhysics;
+	TickFunction.Subsystem = this;
+}
+
+void UGravitySwapSubsystem::Deinitialize()
+{
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+	TickFunction.Subsystem = nullptr;
+
+	PendingFlips.Reset();
+	UndoLog.Reset();
+	UndoHead = 0;
+	NumUndoEntries = 0;
+
+	Super::Deinitialize();
+}
+
+UGravitySwapSubsystem* UGravitySwapSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject != nullptr ? WorldContextObject->GetWorld() : nullptr;
+	if (World == nullptr || World->IsGameWorld() == false) { return nullptr; }
+
+	return World->GetSubsystem<UGravitySwapSubsystem>();
+}
+
+void UGravitySwapSubsystem::RegisterTickFunction()
+{
+	if (TickFunction.IsTickFunctionRegistered()) { return; }
+
+	// Registered lazily since the persistent level isn't guaranteed to exist when the subsystem initializes
+	UWorld* World = GetWorld();
+	if (World == nullptr || World->PersistentLevel == nullptr) { return; }
+
+	TickFunction.RegisterTickFunction(World->PersistentLevel);
+	UpdateInputPrerequisites();
+}
+
+void UGravitySwapSubsystem::UpdateInputPrerequisites()
+{
+	APlayerController* Controller = UGameplayStatics::GetPlayerController(this, 0);
+	if (Controller != PrerequisiteController.Get())
+	{
+		if (APlayerController* OldController = PrerequisiteController.Get())
+		{
+			TickFunction.RemovePrerequisite(OldController, OldController->PrimaryActorTick);
+		}
+		if (Controller != nullptr)
+		{
+			TickFunction.AddPrerequisite(Controller, Controller->PrimaryActorTick);
+		}
+		PrerequisiteController = Controller;
+	}
+
+	// The pawn changes when the player respawns
+	APawn* Pawn = Controller != nullptr ? Controller->GetPawn() : nullptr;
+	if (Pawn != PrerequisitePawn.Get())
+	{
+		if (APawn* OldPawn = PrerequisitePawn.Get())
+		{
+			TickFunction.RemovePrerequisite(OldPawn, OldPawn->PrimaryActorTick);
+		}
+		if (Pawn != nullptr)
+		{
+			TickFunction.AddPrerequisite(Pawn, Pawn->PrimaryActorTick);
+		}
+		PrerequisitePawn = Pawn;
+	}
+}
+
+bool UGravitySwapSubsystem::FindQueuedFlip(const UObject* Target, bool& bOutFlip) const
+{
+	for (const FGravitySwapTransaction& Pending : PendingFlips)
+	{
+		if (Pending.Target.Get() == Target)
+		{
+			bOutFlip = Pending.bNewFlip;
+			return true;
+		}
+	}
+	return false;
+}
+
+void UGravitySwapSubsystem::EnqueueFlip(UObject* Target, bool bNewFlip)
+{
+	IGravitySwappable* Swappable = Cast<IGravitySwappable>(Target);
+	if (Swappable == nullptr) { return; }
+
+	RegisterTickFunction();
+
+	// Coalesce with a flip already queued this frame
+	for (FGravitySwapTransaction& Pending : PendingFlips)
+	{
+		if (Pending.Target.Get() == Target)
+		{
+			Pending.bNewFlip = bNewFlip;
+			return;
+		}
+	}
+
+	FGravitySwapTransaction Transaction;
+	Transaction.Target = Target;
+	Transaction.bOldFlip = Swappable->GetFlipGravity();
+	Transaction.bNewFlip = bNewFlip;
+	PendingFlips.Add(Transaction);
+}
+
+void UGravitySwapSubsystem::Flush()
+{
+	// Takes effect from the next frame
+	UpdateInputPrerequisites();
+
+	// Listeners may queue new flips while being notified. Those are applied in the same frame
+	for (int32 Pass = 0; Pass < MaxFlushPasses && PendingFlips.Num() > 0; Pass++)
+	{
+		TArray<FGravitySwapTransaction> Transactions = MoveTemp(PendingFlips);
+		PendingFlips.Reset();
+		ApplyAndNotify(Transactions, true);
+	}
+}
+
+void UGravitySwapSubsystem::UndoToMark(int32 Mark)
+{
+	Mark = FMath::Clamp(Mark, FirstUndoSequence, GetUndoMark());
+
+	// Whatever was still queued belongs to the state being thrown away
+	PendingFlips.Reset();
+
+	TArray<FGravitySwapTransaction> Reverse;
+	Reverse.Reserve(GetUndoMark() - Mark);
+	for (int32 Sequence = GetUndoMark() - 1; Sequence >= Mark; Sequence--)
+	{
+		const FGravitySwapTransaction& Entry = GetUndoEntry(Sequence);
+		FGravitySwapTransaction Undo = Entry;
+		Undo.bNewFlip = Entry.bOldFlip;
+		Undo.bOldFlip = Entry.bNewFlip;
+		Reverse.Add(Undo);
+	}
+	NumUndoEntries = Mark - FirstUndoSequence;
+
+	ApplyAndNotify(Reverse, false);
+}
+
+void UGravitySwapSubsystem::DiscardAfterMark(int32 Mark)
+{
+	PendingFlips.Reset();
+	NumUndoEntries = FMath::Clamp(Mark, FirstUndoSequence, GetUndoMark()) - FirstUndoSequence;
+}
+
+void UGravitySwapSubsystem::ClearUndoLog()
+{
+	// Marks taken before stay ordered against the ones taken after
+	FirstUndoSequence += NumUndoEntries;
+	NumUndoEntries = 0;
+	UndoHead = 0;
+}
+
+void UGravitySwapSubsystem::AddUndoEntry(const FGravitySwapTransaction& Transaction)
+{
+	if (UndoLog.Num() < MaxUndoLogSize)
+	{
+		UndoLog.SetNum(MaxUndoLogSize);
+	}
+
+	// Full, the oldest entry is overwritten
+	if (NumUndoEntries == MaxUndoLogSize)
+	{
+		UndoHead = (UndoHead + 1) % MaxUndoLogSize;
+		FirstUndoSequence++;
+		NumUndoEntries--;
+	}
+
+	NumUndoEntries++;
+	GetUndoEntry(GetUndoMark() - 1) = Transaction;
+}
+
+FGravitySwapTransaction& UGravitySwapSubsystem::GetUndoEntry(int32 Sequence)
+{
+	return UndoLog[(UndoHead + Sequence - FirstUndoSequence) % MaxUndoLogSize];
+}
+
+void UGravitySwapSubsystem::ApplyAndNotify(const TArray<FGravitySwapTransaction>& Transactions, bool bRecordUndo)
+{
+	TArray<UObject*, TInlineAllocator<16>> Changed;
+
+	for (const FGravitySwapTransaction& Transaction : Transactions)
+	{
+		UObject* Target = Transaction.Target.Get();
+		IGravitySwappable* Swappable = Cast<IGravitySwappable>(Target);
+		if (Swappable == nullptr) { continue; }
+		if (Swappable->GetFlipGravity() == Transaction.bNewFlip) { continue; }
+
+		Swappable->ApplyFlipGravity(Transaction.bNewFlip);
+		Changed.AddUnique(Target);
+
+		if (bRecordUndo)
+		{
+			AddUndoEntry(Transaction);
+		}
+	}
+
+	// Batched notifications, after every flip of this flush is in place
+	for (UObject* Target : Changed)
+	{
+		if (IGravitySwappable* Swappable = Cast<IGravitySwappable>(Target))
+		{
+			Swappable->NotifyFlipGravity();
+		}
+	}
+
+	if (Changed.Num() > 0)
+	{
+		OnFlipsApplied.Broadcast();
+	}
+}
@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineBaseTypes.h"
+#include "GravitySwapSubsystem.generated.h"
+
+//--- forward declarations ---
+class IGravitySwappable;
+class UGravitySwapSubsystem;
+class APlayerController;
+class APawn;
+
+// One recorded flip. OldFlip is what an undo restores
+struct FGravitySwapTransaction
+{
+	TWeakObjectPtr<UObject> Target;
+	bool bOldFlip = false;
+	bool bNewFlip = false;
+};
+
+// Flushes the swap queue once per frame in TG_PrePhysics, after the local player's controller and pawn handled input
+struct FGravitySwapTickFunction : public FTickFunction
+{
+	UGravitySwapSubsystem* Subsystem = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+/**
+ * Queues gravity flips requested during input handling and applies them at a fixed frame phase.
+ * Flips on the same target within a frame are coalesced, and OnFlipGravity notifications are sent
+ * in one batch after every flip of the frame has been applied.
+ * Applied flips are kept in an undo log so puzzle resets can rewind them instead of reloading.
+ */
+UCLASS()
+class GP2_TEAM5_API UGravitySwapSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	static UGravitySwapSubsystem* Get(const UObject* WorldContextObject);
+
+	// Records a flip on Target (an IGravitySwappable). Applied on the next flush
+	void EnqueueFlip(UObject* Target, bool bNewFlip);
+
+	// Applies every queued flip and sends the batched notifications
+	void Flush();
+
+	// Whether a flip of Target is queued, and to what
+	bool FindQueuedFlip(const UObject* Target, bool& bOutFlip) const;
+
+	// Sequence number of the next logged flip. Pass it to UndoToMark to rewind everything recorded after it.
+	// Marks stay valid while old entries are dropped, a mark older than the log undoes as far back as it goes
+	UFUNCTION(BlueprintPure, Category = "Gravity")
+	int32 GetUndoMark() const { return FirstUndoSequence + NumUndoEntries; }
+
+	UFUNCTION(BlueprintCallable, Category = "Gravity")
+	void UndoToMark(int32 Mark);
+
+	UFUNCTION(BlueprintCallable, Category = "Gravity")
+	void UndoAll() { UndoToMark(FirstUndoSequence); }
+
+	UFUNCTION(BlueprintCallable, Category = "Gravity")
+	void ClearUndoLog();
+
+	// Drops queued flips and forgets everything logged after Mark without applying anything.
+	// Used when the state is restored some other way, e.g. from a UGravitySnapshotSubsystem snapshot
+	void DiscardAfterMark(int32 Mark);
+
+	// Broadcast after a flush or undo that changed at least one flip
+	DECLARE_MULTICAST_DELEGATE(FOnFlipsApplied);
+	FOnFlipsApplied OnFlipsApplied;
+
+protected:
+	void RegisterTickFunction();
+
+	// Flips requested from input apply in the same frame, whatever order the ticks were registered in
+	void UpdateInputPrerequisites();
+	void ApplyAndNotify(const TArray<FGravitySwapTransaction>& Transactions, bool bRecordUndo);
+	void AddUndoEntry(const FGravitySwapTransaction& Transaction);
+	FGravitySwapTransaction& GetUndoEntry(int32 Sequence);
+
+	TArray<FGravitySwapTransaction> PendingFlips;
+
+	// Ring buffer, the oldest entry at UndoHead has sequence number FirstUndoSequence
+	TArray<FGravitySwapTransaction> UndoLog;
+	int32 UndoHead = 0;
+	int32 NumUndoEntries = 0;
+	int32 FirstUndoSequence = 0;
+
+	// Oldest entries are dropped once the log grows past this
+	int32 MaxUndoLogSize = 256;
+
+	// Flips requested by notification listeners are applied in the same flush, up to this many passes
+	int32 MaxFlushPasses = 4;
+
+	FGravitySwapTickFunction TickFunction;
+	TWeakObjectPtr<APlayerController> PrerequisiteController;
+	TWeakObjectPtr<APawn> PrerequisitePawn;
+};
@@ -2,5 +2,19 @@
 
 
 #include "GravitySwappable.h"
+#include "GravitySwapSubsystem.h"
 
-// Add default functionality here for any IGravitySwappable functions that are not pure virtual.
\ No newline at end of file
+// Add default functionality here for any IGravitySwappable functions that are not pure virtual.
+
+bool IGravitySwappable::GetPendingFlipGravity() const
+{
+	const UObject* Object = _getUObject();
+	const UGravitySwapSubsystem* SwapSubsystem = UGravitySwapSubsystem::Get(Object);
+
+	bool bQueuedFlip = false;
+	if (SwapSubsystem != nullptr && SwapSubsystem->FindQueuedFlip(Object, bQueuedFlip))
+	{
+		return bQueuedFlip;
+	}
+	return GetFlipGravity();
+}
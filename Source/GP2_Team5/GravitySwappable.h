@@ -27,6 +27,17 @@ public:
 	UFUNCTION(BlueprintCallable)
 	virtual bool GetFlipGravity() const = 0;
 
+	// The flip queued for the next flush, GetFlipGravity if none is
+	UFUNCTION(BlueprintCallable)
+	virtual bool GetPendingFlipGravity() const;
+
+	// Queues the flip on UGravitySwapSubsystem, applied at its next flush. GetFlipGravity keeps the old value until then
 	UFUNCTION(BlueprintCallable)
 	virtual void SetFlipGravity(bool bNewGravity) = 0;
+
+	// Sets the flip right away without notifying. Called by UGravitySwapSubsystem when it flushes
+	virtual void ApplyFlipGravity(bool bNewGravity) = 0;
+
+	// Called once per flush after every flip of the frame has been applied
+	virtual void NotifyFlipGravity() {}
 };
\ No newline at end of file
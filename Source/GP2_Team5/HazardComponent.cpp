@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HazardComponent.h"
+#include "HazardSubsystem.h"
+
+UHazardComponent::UHazardComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UHazardComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UHazardSubsystem* Hazards = UHazardSubsystem::Get(this))
+	{
+		Hazards->Register(this);
+	}
+}
+
+void UHazardComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UHazardSubsystem* Hazards = UHazardSubsystem::Get(this))
+	{
+		Hazards->Unregister(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
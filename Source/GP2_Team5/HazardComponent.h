@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+#include "Enums.h"
+#include "HazardComponent.generated.h"
+
+/**
+ * A shape that kills pawns inside it. Tested by UHazardSubsystem against pawn locations once per frame,
+ * without collision or overlap events.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class GP2_TEAM5_API UHazardComponent : public USceneComponent
+{
+	GENERATED_BODY()
+
+public:
+	UHazardComponent();
+
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnHazardKill, APawn*, Pawn);
+
+	/* Broadcast when a pawn enters this hazard */
+	UPROPERTY(BlueprintAssignable, Category = "Hazard")
+	FOnHazardKill OnKill;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Hazard")
+	EHazardShape Shape = EHazardShape::Box;
+
+	/* Half size of the box, scaled by the component */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Hazard")
+	FVector BoxExtent = FVector(100.f);
+
+	/* Scaled by the component's largest scale axis */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Hazard")
+	float SphereRadius = 100.f;
+
+	/* Distances from the component (a planet's center) between which pawns die. Not scaled */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Hazard")
+	float MinAltitude = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Hazard")
+	float MaxAltitude = 100.f;
+
+	/* Re-read the shape every frame. Hazards that don't move are only read when registered */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Hazard")
+	bool bMoves = false;
+
+protected:
+	friend class UHazardSubsystem;
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Slot in UHazardSubsystem, INDEX_NONE while unregistered
+	int32 HazardIndex = INDEX_NONE;
+};
@@ -0,0 +1,359 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HazardSubsystem.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "EngineUtils.h"
+#include "GameFramework/Pawn.h"
+#include "Kismet/GameplayStatics.h"
+#include "HazardComponent.h"
+#include "CheckpointSubsystem.h"
+
+// Parameter layout of each shape
+namespace HazardParams
+{
+	enum
+	{
+		CenterX, CenterY, CenterZ,
+
+		SphereRadiusSquared = 3,
+
+		BoxAxisXX = 3, BoxAxisXY, BoxAxisXZ,
+		BoxAxisYX, BoxAxisYY, BoxAxisYZ,
+		BoxAxisZX, BoxAxisZY, BoxAxisZZ,
+		BoxExtentX, BoxExtentY, BoxExtentZ,
+
+		BandMinSquared = 3, BandMaxSquared,
+	};
+
+	// Lanes nothing is inside: a negative radius or extent, a band that ends before it starts
+	static const float EmptySphere[MaxHazardParams] = { 0.f, 0.f, 0.f, -1.f };
+	static const float EmptyBox[MaxHazardParams] = { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, -1.f, -1.f, -1.f };
+	static const float EmptyBand[MaxHazardParams] = { 0.f, 0.f, 0.f, 1.f, -1.f };
+}
+
+// Each returns the first lane containing the point, INDEX_NONE if none does
+static int32 FindInSpheres(const FVector& Point, const FHazardLanes& Lanes)
+{
+	using namespace HazardParams;
+	const VectorRegister PX = VectorSetFloat1(Point.X);
+	const VectorRegister PY = VectorSetFloat1(Point.Y);
+	const VectorRegister PZ = VectorSetFloat1(Point.Z);
+	for (int32 i = 0; i < Lanes.NumLanes; i += 4)
+	{
+		const VectorRegister DX = VectorSubtract(PX, VectorLoad(&Lanes.Params[CenterX][i]));
+		const VectorRegister DY = VectorSubtract(PY, VectorLoad(&Lanes.Params[CenterY][i]));
+		const VectorRegister DZ = VectorSubtract(PZ, VectorLoad(&Lanes.Params[CenterZ][i]));
+		const VectorRegister DistanceSquared = VectorMultiplyAdd(DZ, DZ, VectorMultiplyAdd(DY, DY, VectorMultiply(DX, DX)));
+
+		const int32 Inside = VectorMaskBits(VectorCompareLE(DistanceSquared, VectorLoad(&Lanes.Params[SphereRadiusSquared][i])));
+		if (Inside != 0) { return i + FMath::CountTrailingZeros(Inside); }
+	}
+	return INDEX_NONE;
+}
+
+static int32 FindInBoxes(const FVector& Point, const FHazardLanes& Lanes)
+{
+	using namespace HazardParams;
+	const VectorRegister PX = VectorSetFloat1(Point.X);
+	const VectorRegister PY = VectorSetFloat1(Point.Y);
+	const VectorRegister PZ = VectorSetFloat1(Point.Z);
+	for (int32 i = 0; i < Lanes.NumLanes; i += 4)
+	{
+		const VectorRegister DX = VectorSubtract(PX, VectorLoad(&Lanes.Params[CenterX][i]));
+		const VectorRegister DY = VectorSubtract(PY, VectorLoad(&Lanes.Params[CenterY][i]));
+		const VectorRegister DZ = VectorSubtract(PZ, VectorLoad(&Lanes.Params[CenterZ][i]));
+
+		// The offset in the box's own axes, compared to its half size
+		VectorRegister InsideAxes[3];
+		for (int32 Axis = 0; Axis < 3; Axis++)
+		{
+			const int32 AxisParam = BoxAxisXX + Axis * 3;
+			const VectorRegister Local = VectorMultiplyAdd(DZ, VectorLoad(&Lanes.Params[AxisParam + 2][i]),
+				VectorMultiplyAdd(DY, VectorLoad(&Lanes.Params[AxisParam + 1][i]), VectorMultiply(DX, VectorLoad(&Lanes.Params[AxisParam][i]))));
+			InsideAxes[Axis] = VectorCompareLE(VectorAbs(Local), VectorLoad(&Lanes.Params[BoxExtentX + Axis][i]));
+		}
+
+		const int32 InsideMask = VectorMaskBits(VectorBitwiseAnd(VectorBitwiseAnd(InsideAxes[0], InsideAxes[1]), InsideAxes[2]));
+		if (InsideMask != 0) { return i + FMath::CountTrailingZeros(InsideMask); }
+	}
+	return INDEX_NONE;
+}
+
+static int32 FindInBands(const FVector& Point, const FHazardLanes& Lanes)
+{
+	using namespace HazardParams;
+	const VectorRegister PX = VectorSetFloat1(Point.X);
+	const VectorRegister PY = VectorSetFloat1(Point.Y);
+	const VectorRegister PZ = VectorSetFloat1(Point.Z);
+	for (int32 i = 0; i < Lanes.NumLanes; i += 4)
+	{
+		const VectorRegister DX = VectorSubtract(PX, VectorLoad(&Lanes.Params[CenterX][i]));
+		const VectorRegister DY = VectorSubtract(PY, VectorLoad(&Lanes.Params[CenterY][i]));
+		const VectorRegister DZ = VectorSubtract(PZ, VectorLoad(&Lanes.Params[CenterZ][i]));
+		const VectorRegister DistanceSquared = VectorMultiplyAdd(DZ, DZ, VectorMultiplyAdd(DY, DY, VectorMultiply(DX, DX)));
+
+		const VectorRegister AboveMin = VectorCompareGE(DistanceSquared, VectorLoad(&Lanes.Params[BandMinSquared][i]));
+		const VectorRegister BelowMax = VectorCompareLE(DistanceSquared, VectorLoad(&Lanes.Params[BandMaxSquared][i]));
+		const int32 Inside = VectorMaskBits(VectorBitwiseAnd(AboveMin, BelowMax));
+		if (Inside != 0) { return i + FMath::CountTrailingZeros(Inside); }
+	}
+	return INDEX_NONE;
+}
+
+void FHazardLanes::Reset()
+{
+	for (TArray<float>& Param : Params)
+	{
+		Param.Reset();
+	}
+	Hazards.Reset();
+	NumLanes = 0;
+}
+
+void FHazardLanes::Pad(const float (&Empty)[MaxHazardParams])
+{
+	NumLanes = Align(Hazards.Num(), 4);
+	for (int32 Param = 0; Param < MaxHazardParams; Param++)
+	{
+		// Real lanes are written afterwards
+		Params[Param].Init(Empty[Param], NumLanes);
+	}
+}
+
+void FHazardTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Subsystem != nullptr)
+	{
+		Subsystem->TestPawns();
+	}
+}
+
+FString FHazardTickFunction::DiagnosticMessage()
+{
+	return TEXT("UHazardSubsystem::TestPawns");
+}
+
+void UHazardSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	TickFunction.bCanEverTick = true;
+	TickFunction.bStartWithTickEnabled = true;
+	TickFunction.TickGroup = TG_PostPhysics;
+	TickFunction.Subsystem = this;
+}
+
+void UHazardSubsystem::Deinitialize()
+{
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+	TickFunction.Subsystem = nullptr;
+
+	for (UHazardComponent* Hazard : Hazards)
+	{
+		Hazard->HazardIndex = INDEX_NONE;
+	}
+	Hazards.Reset();
+	HazardLanes.Reset();
+	for (FHazardLanes& Lanes : ShapeLanes)
+	{
+		Lanes.Reset();
+	}
+	InsidePawns.Reset();
+	PreviousInsidePawns.Reset();
+	Kills.Reset();
+
+	Super::Deinitialize();
+}
+
+UHazardSubsystem* UHazardSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject != nullptr ? WorldContextObject->GetWorld() : nullptr;
+	if (World == nullptr || World->IsGameWorld() == false) { return nullptr; }
+
+	return World->GetSubsystem<UHazardSubsystem>();
+}
+
+void UHazardSubsystem::Register(UHazardComponent* Hazard)
+{
+	if (Hazard == nullptr || Hazard->HazardIndex != INDEX_NONE) { return; }
+
+	// Registered lazily since the persistent level isn't guaranteed to exist when the subsystem initializes
+	if (TickFunction.IsTickFunctionRegistered() == false && GetWorld()->PersistentLevel != nullptr)
+	{
+		TickFunction.RegisterTickFunction(GetWorld()->PersistentLevel);
+	}
+
+	Hazard->HazardIndex = Hazards.Add(Hazard);
+	HazardLanes.Add(INDEX_NONE);
+	NumMovingHazards += Hazard->bMoves ? 1 : 0;
+	bLanesDirty = true;
+}
+
+void UHazardSubsystem::Unregister(UHazardComponent* Hazard)
+{
+	if (Hazard == nullptr || Hazards.IsValidIndex(Hazard->HazardIndex) == false) { return; }
+
+	const int32 Index = Hazard->HazardIndex;
+	Hazard->HazardIndex = INDEX_NONE;
+	NumMovingHazards -= Hazard->bMoves ? 1 : 0;
+	Hazards.RemoveAtSwap(Index, 1, false);
+	HazardLanes.RemoveAtSwap(Index, 1, false);
+
+	// The last entry moved into the freed slot
+	if (Hazards.IsValidIndex(Index))
+	{
+		Hazards[Index]->HazardIndex = Index;
+	}
+	bLanesDirty = true;
+}
+
+void UHazardSubsystem::UpdateLanes()
+{
+	const bool bRebuild = bLanesDirty;
+	if (bRebuild)
+	{
+		bLanesDirty = false;
+		for (FHazardLanes& Lanes : ShapeLanes)
+		{
+			Lanes.Reset();
+		}
+		for (int32 i = 0; i < Hazards.Num(); i++)
+		{
+			HazardLanes[i] = ShapeLanes[static_cast<int32>(Hazards[i]->Shape)].Hazards.Add(Hazards[i]);
+		}
+
+		ShapeLanes[static_cast<int32>(EHazardShape::Box)].Pad(HazardParams::EmptyBox);
+		ShapeLanes[static_cast<int32>(EHazardShape::Sphere)].Pad(HazardParams::EmptySphere);
+		ShapeLanes[static_cast<int32>(EHazardShape::AltitudeBand)].Pad(HazardParams::EmptyBand);
+	}
+	else if (NumMovingHazards == 0)
+	{
+		return;
+	}
+
+	for (int32 i = 0; i < Hazards.Num(); i++)
+	{
+		const UHazardComponent* Hazard = Hazards[i];
+		if (bRebuild || Hazard->bMoves)
+		{
+			WriteLane(Hazard, ShapeLanes[static_cast<int32>(Hazard->Shape)], HazardLanes[i]);
+		}
+	}
+}
+
+void UHazardSubsystem::WriteLane(const UHazardComponent* Hazard, FHazardLanes& Lanes, int32 Lane) const
+{
+	using namespace HazardParams;
+	const FTransform& Transform = Hazard->GetComponentTransform();
+	const FVector Center = Transform.GetLocation();
+	Lanes.Params[CenterX][Lane] = Center.X;
+	Lanes.Params[CenterY][Lane] = Center.Y;
+	Lanes.Params[CenterZ][Lane] = Center.Z;
+
+	switch (Hazard->Shape)
+	{
+	case EHazardShape::Sphere:
+	{
+		const float Radius = Hazard->SphereRadius * Transform.GetMaximumAxisScale();
+		Lanes.Params[SphereRadiusSquared][Lane] = Radius * Radius;
+		break;
+	}
+	case EHazardShape::Box:
+	{
+		const FQuat Rotation = Transform.GetRotation();
+		const FVector Axes[3] = { Rotation.GetAxisX(), Rotation.GetAxisY(), Rotation.GetAxisZ() };
+		const FVector Extent = Hazard->BoxExtent * Transform.GetScale3D().GetAbs();
+		for (int32 Axis = 0; Axis < 3; Axis++)
+		{
+			Lanes.Params[BoxAxisXX + Axis * 3][Lane] = Axes[Axis].X;
+			Lanes.Params[BoxAxisXX + Axis * 3 + 1][Lane] = Axes[Axis].Y;
+			Lanes.Params[BoxAxisXX + Axis * 3 + 2][Lane] = Axes[Axis].Z;
+			Lanes.Params[BoxExtentX + Axis][Lane] = Extent[Axis];
+		}
+		break;
+	}
+	case EHazardShape::AltitudeBand:
+	{
+		const float MinAltitude = FMath::Max(Hazard->MinAltitude, 0.f);
+		Lanes.Params[BandMinSquared][Lane] = MinAltitude * MinAltitude;
+		Lanes.Params[BandMaxSquared][Lane] = Hazard->MaxAltitude >= MinAltitude ? Hazard->MaxAltitude * Hazard->MaxAltitude : -1.f;
+		break;
+	}
+	}
+}
+
+UHazardComponent* UHazardSubsystem::FindHazard(const FVector& Location)
+{
+	UpdateLanes();
+	return FindHazardInLanes(Location);
+}
+
+UHazardComponent* UHazardSubsystem::FindHazardInLanes(const FVector& Location) const
+{
+	const FHazardLanes& Boxes = ShapeLanes[static_cast<int32>(EHazardShape::Box)];
+	const int32 Box = FindInBoxes(Location, Boxes);
+	if (Box != INDEX_NONE) { return Boxes.Hazards[Box]; }
+
+	const FHazardLanes& Spheres = ShapeLanes[static_cast<int32>(EHazardShape::Sphere)];
+	const int32 Sphere = FindInSpheres(Location, Spheres);
+	if (Sphere != INDEX_NONE) { return Spheres.Hazards[Sphere]; }
+
+	const FHazardLanes& Bands = ShapeLanes[static_cast<int32>(EHazardShape::AltitudeBand)];
+	const int32 Band = FindInBands(Location, Bands);
+	return Band != INDEX_NONE ? Bands.Hazards[Band] : nullptr;
+}
+
+void UHazardSubsystem::TestPawns()
+{
+	if (Hazards.Num() == 0) { return; }
+
+	UpdateLanes();
+
+	// Only the pawns that weren't inside last frame die
+	Swap(InsidePawns, PreviousInsidePawns);
+	InsidePawns.Reset();
+	Kills.Reset();
+	for (TActorIterator<APawn> It(GetWorld()); It; ++It)
+	{
+		UHazardComponent* Hazard = FindHazardInLanes(It->GetActorLocation());
+		if (Hazard == nullptr) { continue; }
+
+		InsidePawns.Add(*It);
+		if (PreviousInsidePawns.Contains(*It) == false)
+		{
+			Kills.Emplace(*It, Hazard);
+		}
+	}
+
+	// After the pass, listeners and the respawn move things around
+	const APawn* Player = UGameplayStatics::GetPlayerPawn(this, 0);
+	for (const TPair<APawn*, UHazardComponent*>& Kill : Kills)
+	{
+		if (IsValid(Kill.Key) == false || IsValid(Kill.Value) == false) { continue; }
+
+		Kill.Value->OnKill.Broadcast(Kill.Key);
+		OnPawnKilled.Broadcast(Kill.Key, Kill.Value);
+
+		if (bRespawnPlayer && Kill.Key == Player)
+		{
+			RespawnPlayer();
+		}
+	}
+}
+
+void UHazardSubsystem::RespawnPlayer()
+{
+	UCheckpointSubsystem* Checkpoints = UCheckpointSubsystem::Get(this);
+	if (Checkpoints == nullptr || Checkpoints->Respawn()) { return; }
+
+	// No checkpoint reached yet, the player would stay inside the hazard and never die again
+	if (Checkpoints->RespawnAtPlayerStart() == false)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("No checkpoint or player start to respawn the player at"));
+	}
+}
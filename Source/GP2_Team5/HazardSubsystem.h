@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineBaseTypes.h"
+#include "HazardSubsystem.generated.h"
+
+//--- forward declarations ---
+class UHazardComponent;
+class UHazardSubsystem;
+class APawn;
+
+// Tests pawns against the hazards once per frame after physics
+struct FHazardTickFunction : public FTickFunction
+{
+	UHazardSubsystem* Subsystem = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+// Largest number of floats a hazard shape is described with (an oriented box)
+static constexpr int32 MaxHazardParams = 15;
+
+// Shapes of one kind, one array per parameter with one lane per shape, so four shapes are tested at once.
+// Padded to a multiple of four with shapes nothing is inside
+struct FHazardLanes
+{
+	TArray<float> Params[MaxHazardParams];
+	TArray<UHazardComponent*> Hazards;
+	int32 NumLanes = 0;
+
+	void Reset();
+	void Pad(const float (&Empty)[MaxHazardParams]);
+};
+
+/**
+ * Kills pawns that enter a hazard. Hazards are analytic shapes (boxes, spheres and altitude bands around a planet)
+ * tested against each pawn's location once per frame, four shapes at a time, instead of ticking kill volumes
+ * waiting for physics overlaps.
+ * Deaths are reported once per entry through OnPawnKilled and the hazard's OnKill. The player is respawned at the
+ * last checkpoint by UCheckpointSubsystem, or at the player start if no checkpoint was reached yet.
+ */
+UCLASS()
+class GP2_TEAM5_API UHazardSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	static UHazardSubsystem* Get(const UObject* WorldContextObject);
+
+	void Register(UHazardComponent* Hazard);
+	void Unregister(UHazardComponent* Hazard);
+
+	// Tests every pawn against every hazard and sends the death events
+	void TestPawns();
+
+	// The first hazard Location is inside, nullptr if none
+	UFUNCTION(BlueprintPure, Category = "Hazard")
+	UHazardComponent* FindHazard(const FVector& Location);
+
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnPawnKilled, APawn*, Pawn, UHazardComponent*, Hazard);
+
+	UPROPERTY(BlueprintAssignable, Category = "Hazard")
+	FOnPawnKilled OnPawnKilled;
+
+	/* Respawn the player at the last checkpoint when it dies, or at the player start before the first one. Off when Blueprints drive the respawn */
+	UPROPERTY(BlueprintReadWrite, Category = "Hazard")
+	bool bRespawnPlayer = true;
+
+protected:
+	// Rewrites the lanes after hazards were added or removed, and the lanes of moving hazards
+	void UpdateLanes();
+	UHazardComponent* FindHazardInLanes(const FVector& Location) const;
+	void WriteLane(const UHazardComponent* Hazard, FHazardLanes& Lanes, int32 Lane) const;
+	void RespawnPlayer();
+
+	TArray<UHazardComponent*> Hazards;
+	// Same index as Hazards, the hazard's lane in the lanes of its shape
+	TArray<int32> HazardLanes;
+	int32 NumMovingHazards = 0;
+
+	// One per EHazardShape
+	FHazardLanes ShapeLanes[3];
+	bool bLanesDirty = false;
+
+	// Pawns inside a hazard, they die once on the way in
+	TArray<APawn*> InsidePawns;
+	TArray<APawn*> PreviousInsidePawns;
+	TArray<TPair<APawn*, UHazardComponent*>> Kills;
+
+	FHazardTickFunction TickFunction;
+};
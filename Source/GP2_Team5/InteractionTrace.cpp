@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InteractionTrace.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectArray.h"
+
+DEFINE_LOG_CATEGORY(LogInteraction);
+
+#if INTERACTION_TRACE_ENABLED
+
+FInteractionTraceRecord FInteractionTrace::Records[FInteractionTrace::Capacity];
+TAtomic<uint32> FInteractionTrace::WriteIndex(0);
+
+static FAutoConsoleCommand DumpInteractionTraceCommand(
+	TEXT("Interaction.DumpTrace"),
+	TEXT("Writes the interaction event trace to Saved/Logs. Optional argument: file name"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FInteractionTrace::Dump(Args.Num() > 0 ? Args[0] : TEXT("InteractionTrace.csv"));
+	}));
+
+static FString GetTraceObjectName(int32 ObjectId)
+{
+	if (ObjectId == INDEX_NONE) { return TEXT(""); }
+
+	// The id may have been reused since the record was written. Good enough for diagnostics
+	FUObjectItem* Item = GUObjectArray.IndexToObject(ObjectId);
+	UObject* Object = Item != nullptr ? static_cast<UObject*>(Item->Object) : nullptr;
+	return Object != nullptr ? Object->GetName() : FString::FromInt(ObjectId);
+}
+
+void FInteractionTrace::Record(EInteractionTraceEvent Event, EInteractionTraceReason Reason, const UObject* Object, const UObject* OtherObject)
+{
+	const uint32 Slot = WriteIndex.IncrementExchange() & (Capacity - 1);
+
+	FInteractionTraceRecord& Entry = Records[Slot];
+	Entry.Time = FPlatformTime::Seconds();
+	Entry.Frame = GFrameCounter;
+	Entry.ObjectId = Object != nullptr ? Object->GetUniqueID() : INDEX_NONE;
+	Entry.OtherObjectId = OtherObject != nullptr ? OtherObject->GetUniqueID() : INDEX_NONE;
+	Entry.Event = Event;
+	Entry.Reason = Reason;
+}
+
+bool FInteractionTrace::Dump(const FString& FileName)
+{
+	const uint32 Written = WriteIndex.Load();
+	const uint32 Count = FMath::Min(Written, Capacity);
+
+	FString Output = TEXT("Frame,Time,Event,Reason,Object,OtherObject\n");
+	for (uint32 i = Written - Count; i != Written; i++)
+	{
+		const FInteractionTraceRecord& Entry = Records[i & (Capacity - 1)];
+		Output += FString::Printf(TEXT("%llu,%.6f,%s,%s,%s,%s\n"),
+			Entry.Frame, Entry.Time, ToString(Entry.Event), ToString(Entry.Reason),
+			*GetTraceObjectName(Entry.ObjectId), *GetTraceObjectName(Entry.OtherObjectId));
+	}
+
+	const FString FilePath = FPaths::Combine(FPaths::ProjectLogDir(), FileName);
+	if (FFileHelper::SaveStringToFile(Output, *FilePath) == false)
+	{
+		UE_LOG(LogInteraction, Error, TEXT("Couldn't write interaction trace to %s"), *FilePath);
+		return false;
+	}
+
+	UE_LOG(LogInteraction, Log, TEXT("Wrote %u interaction trace records to %s"), Count, *FilePath);
+	return true;
+}
+
+const TCHAR* FInteractionTrace::ToString(EInteractionTraceEvent Event)
+{
+	switch (Event)
+	{
+	case EInteractionTraceEvent::ClickInteract:			return TEXT("ClickInteract");
+	case EInteractionTraceEvent::ClickReset:			return TEXT("ClickReset");
+	case EInteractionTraceEvent::CanSwapGravity:		return TEXT("CanSwapGravity");
+	case EInteractionTraceEvent::Clickable:				return TEXT("Clickable");
+	case EInteractionTraceEvent::ApproachInteract:		return TEXT("ApproachInteract");
+	case EInteractionTraceEvent::ShowInteractionWidget:	return TEXT("ShowInteractionWidget");
+	case EInteractionTraceEvent::HideInteractionWidget:	return TEXT("HideInteractionWidget");
+	case EInteractionTraceEvent::CollectibleOverlap:	return TEXT("CollectibleOverlap");
+	case EInteractionTraceEvent::LaserStraight:			return TEXT("LaserStraight");
+	}
+	return TEXT("Unknown");
+}
+
+const TCHAR* FInteractionTrace::ToString(EInteractionTraceReason Reason)
+{
+	switch (Reason)
+	{
+	case EInteractionTraceReason::None:					return TEXT("None");
+	case EInteractionTraceReason::Accepted:				return TEXT("Accepted");
+	case EInteractionTraceReason::JumpingOrGrabbing:	return TEXT("JumpingOrGrabbing");
+	case EInteractionTraceReason::HitNothing:			return TEXT("HitNothing");
+	case EInteractionTraceReason::OutOfRange:			return TEXT("OutOfRange");
+	case EInteractionTraceReason::NotClickInteractable:	return TEXT("NotClickInteractable");
+	case EInteractionTraceReason::NewFocus:				return TEXT("NewFocus");
+	case EInteractionTraceReason::SameFocus:			return TEXT("SameFocus");
+	case EInteractionTraceReason::Swapped:				return TEXT("Swapped");
+	case EInteractionTraceReason::NotSwapPartner:		return TEXT("NotSwapPartner");
+	case EInteractionTraceReason::NoRelic1:				return TEXT("NoRelic1");
+	case EInteractionTraceReason::NoRelic2:				return TEXT("NoRelic2");
+	case EInteractionTraceReason::NoSwapComponent:		return TEXT("NoSwapComponent");
+	case EInteractionTraceReason::SameGravity:			return TEXT("SameGravity");
+	case EInteractionTraceReason::NotInLineOfSight:		return TEXT("NotInLineOfSight");
+	case EInteractionTraceReason::NotPlayer:			return TEXT("NotPlayer");
+	case EInteractionTraceReason::BounceCW:				return TEXT("BounceCW");
+	case EInteractionTraceReason::BounceCCW:			return TEXT("BounceCCW");
+	case EInteractionTraceReason::NoHit:				return TEXT("NoHit");
+	}
+	return TEXT("Unknown");
+}
+
+#endif
@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogInteraction, Log, All);
+
+// The tracer is compiled out of Shipping builds together with every INTERACTION_TRACE call site
+#define INTERACTION_TRACE_ENABLED !UE_BUILD_SHIPPING
+
+enum class EInteractionTraceEvent : uint8
+{
+	ClickInteract,
+	ClickReset,
+	CanSwapGravity,
+	Clickable,
+	ApproachInteract,
+	ShowInteractionWidget,
+	HideInteractionWidget,
+	CollectibleOverlap,
+	LaserStraight,
+};
+
+enum class EInteractionTraceReason : uint8
+{
+	None,
+	Accepted,
+	JumpingOrGrabbing,
+	HitNothing,
+	OutOfRange,
+	NotClickInteractable,
+	NewFocus,
+	SameFocus,
+	Swapped,
+	NotSwapPartner,
+	NoRelic1,
+	NoRelic2,
+	NoSwapComponent,
+	SameGravity,
+	NotInLineOfSight,
+	NotPlayer,
+	BounceCW,
+	BounceCCW,
+	NoHit,
+};
+
+#if INTERACTION_TRACE_ENABLED
+
+// One structured trace entry. Object ids are UObject unique ids, resolved to names only when dumped
+struct FInteractionTraceRecord
+{
+	double Time = 0.0;
+	uint64 Frame = 0;
+	int32 ObjectId = INDEX_NONE;
+	int32 OtherObjectId = INDEX_NONE;
+	EInteractionTraceEvent Event = EInteractionTraceEvent::ClickInteract;
+	EInteractionTraceReason Reason = EInteractionTraceReason::None;
+};
+
+/**
+ * Fixed-size ring buffer of interaction events.
+ * Writers claim a slot with a single atomic increment, so recording never locks, allocates or formats strings.
+ * The buffer is written out with the "Interaction.DumpTrace [FileName]" console command.
+ */
+class GP2_TEAM5_API FInteractionTrace
+{
+public:
+	static void Record(EInteractionTraceEvent Event, EInteractionTraceReason Reason, const UObject* Object = nullptr, const UObject* OtherObject = nullptr);
+
+	// Writes the buffered records, oldest first, as CSV to Saved/Logs. Returns false if the file couldn't be written
+	static bool Dump(const FString& FileName);
+
+	static const TCHAR* ToString(EInteractionTraceEvent Event);
+	static const TCHAR* ToString(EInteractionTraceReason Reason);
+
+private:
+	// Power of two so the slot is a mask of the write index
+	static constexpr uint32 Capacity = 4096;
+
+	static FInteractionTraceRecord Records[Capacity];
+	static TAtomic<uint32> WriteIndex;
+};
+
+#define INTERACTION_TRACE(Event, Reason, Object, OtherObject) FInteractionTrace::Record(EInteractionTraceEvent::Event, EInteractionTraceReason::Reason, Object, OtherObject)
+
+#else
+
+#define INTERACTION_TRACE(Event, Reason, Object, OtherObject)
+
+#endif
@@ -2,26 +2,37 @@
 
 
 #include "KillBox.h"
+#include "Components/BoxComponent.h"
+#include "HazardComponent.h"
 
 // Sets default values
 AKillBox::AKillBox()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
-
+	PrimaryActorTick.bCanEverTick = false;
 }
 
 // Called when the game starts or when spawned
 void AKillBox::BeginPlay()
 {
 	Super::BeginPlay();
-	
-}
-
-// Called every frame
-void AKillBox::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
 
+	if (bUseHazard == false) { return; }
+
+	UBoxComponent* Box = FindComponentByClass<UBoxComponent>();
+	if (Box == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s uses a hazard but has no box component to size it from"), *GetName());
+		return;
+	}
+
+	// Follows the box's transform, so only the unscaled extent is copied
+	Hazard = NewObject<UHazardComponent>(this, TEXT("Hazard"));
+	Hazard->Shape = EHazardShape::Box;
+	Hazard->BoxExtent = Box->GetUnscaledBoxExtent();
+	Hazard->bMoves = Box->Mobility == EComponentMobility::Movable;
+	Hazard->SetupAttachment(Box);
+	Hazard->RegisterComponent();
+
+	// Otherwise the Blueprint respawns the player a second time
+	Box->SetGenerateOverlapEvents(false);
 }
-
@@ -6,6 +6,13 @@
 #include "GameFramework/Actor.h"
 #include "KillBox.generated.h"
 
+/**
+ * A box that kills pawns entering it. By default the Blueprint's own box overlap does the killing.
+ * With bUseHazard the actor's box component becomes a UHazardComponent tested by UHazardSubsystem instead, its overlap
+ * events are turned off, and the player is respawned by UCheckpointSubsystem rather than by the Blueprint.
+ * That respawn needs the level's checkpoints to be entered through UCheckpointSubsystem, with bEnterOnOverlap or a
+ * Blueprint calling EnterCheckpoint. Until one is, the player only goes back to the player start and the world stays as it is.
+ */
 UCLASS()
 class GP2_TEAM5_API AKillBox : public AActor
 {
@@ -19,8 +26,10 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+	/* Kill through UHazardSubsystem, sized from the actor's box component */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Hazard")
+	bool bUseHazard = false;
 
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "Hazard")
+	class UHazardComponent* Hazard = nullptr;
 };
@@ -0,0 +1,161 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LaserArcQuery.h"
+#include "Engine/World.h"
+#include "Components/PrimitiveComponent.h"
+
+bool FLaserArcQuery::Trace(const UWorld* World, const FCollisionQueryParams& Params, FHitResult& OutHit, FVector& OutDirection, TArray<FVector>& OutPoints, TArray<UPrimitiveComponent*>* OutCandidates)
+{
+	Begin(World, Params, OutCandidates);
+	Step(MAX_int32, OutPoints);
+	if (bHit == false) { return false; }
+
+	OutHit = Hit;
+	OutDirection = HitDirection;
+	return true;
+}
+
+void FLaserArcQuery::Begin(const UWorld* World, const FCollisionQueryParams& Params, TArray<UPrimitiveComponent*>* OutCandidates)
+{
+	NumQueries = 0;
+	Candidates.Reset();
+	QueryParams = Params;
+	Angle = StartAngle;
+	Travelled = 0.f;
+	bHit = false;
+	HitDirection = FVector::ZeroVector;
+	bDone = World == nullptr || Radius <= KINDA_SMALL_NUMBER || MaxStep <= 0.f || Span == 0.f;
+	if (bDone) { return; }
+
+	GatherCandidates(World);
+	if (OutCandidates != nullptr)
+	{
+		for (const FCandidate& Candidate : Candidates)
+		{
+			OutCandidates->Add(Candidate.Component.Get());
+		}
+	}
+}
+
+int32 FLaserArcQuery::Step(int32 TraceAllowance, TArray<FVector>& OutPoints)
+{
+	const int32 FirstQuery = NumQueries;
+	const float Sign = FMath::Sign(Span);
+	const float TotalAngle = FMath::Abs(Span);
+	const float SmallestStep = FMath::Clamp(MinStep, KINDA_SMALL_NUMBER, MaxStep);
+
+	while (bDone == false && (NumQueries == FirstQuery || NumQueries - FirstQuery < TraceAllowance))
+	{
+		const FVector StartPoint = GetPoint(Angle);
+
+		const float FreeStep = GetFreeStep(Angle, StartPoint);
+		const float StepAngle = FMath::Min(FMath::Clamp(FreeStep, SmallestStep, MaxStep), TotalAngle - Travelled);
+		const float EndAngle = Angle + Sign * StepAngle;
+		const float MidAngle = Angle + Sign * StepAngle * 0.5f;
+		const FVector EndPoint = GetPoint(EndAngle);
+
+		// Only steps next to a candidate are traced
+		for (const FCandidate& Candidate : Candidates)
+		{
+			const float AngleToCandidate = FMath::Abs(FMath::FindDeltaAngleRadians(MidAngle, Candidate.CenterAngle));
+			if (AngleToCandidate > Candidate.HalfAngle + StepAngle * 0.5f) { continue; }
+
+			UPrimitiveComponent* Component = Candidate.Component.Get();
+			if (Component == nullptr) { continue; }
+
+			FHitResult StepHit;
+			NumQueries++;
+			if (Component->LineTraceComponent(StepHit, StartPoint, EndPoint, QueryParams) && (bHit == false || StepHit.Time < Hit.Time))
+			{
+				Hit = StepHit;
+				bHit = true;
+			}
+		}
+
+		if (bHit)
+		{
+			HitDirection = (EndPoint - StartPoint).GetSafeNormal();
+			OutPoints.Add(Hit.ImpactPoint);
+			bDone = true;
+			break;
+		}
+
+		OutPoints.Add(EndPoint);
+		Angle = EndAngle;
+		Travelled += StepAngle;
+		bDone = Travelled >= TotalAngle;
+	}
+	return NumQueries - FirstQuery;
+}
+
+float FLaserArcQuery::GetFreeStep(float FromAngle, const FVector& Point) const
+{
+	float FreeStep = BIG_NUMBER;
+	for (const FCandidate& Candidate : Candidates)
+	{
+		if (Candidate.HalfAngle >= PI) { continue; }
+
+		// A chord no longer than the distance to the bounds can't reach them. The box is tighter along long
+		// platforms, the sphere around the corners of the box
+		const float SphereDistance = FVector::Dist(Point, Candidate.Center) - Candidate.SphereRadius;
+		const float BoxDistance = FMath::Sqrt(Candidate.Box.ComputeSquaredDistanceToPoint(Point));
+		const float DistanceStep = FMath::Max(SphereDistance, BoxDistance) / Radius;
+
+		const float AngleStep = FMath::Abs(FMath::FindDeltaAngleRadians(FromAngle, Candidate.CenterAngle)) - Candidate.HalfAngle;
+		FreeStep = FMath::Min(FreeStep, FMath::Max(DistanceStep, AngleStep));
+	}
+	return FMath::Max(FreeStep, 0.f);
+}
+
+void FLaserArcQuery::GatherCandidates(const UWorld* World)
+{
+	// Bounds of the arc: its end points plus every axis extreme it passes
+	FBox ArcBounds(ForceInit);
+	ArcBounds += GetPoint(StartAngle);
+	ArcBounds += GetPoint(StartAngle + Span);
+	const float MinAngle = FMath::Min(StartAngle, StartAngle + Span);
+	const float MaxAngle = FMath::Max(StartAngle, StartAngle + Span);
+	for (float Extreme = FMath::CeilToFloat(MinAngle / HALF_PI) * HALF_PI; Extreme < MaxAngle; Extreme += HALF_PI)
+	{
+		ArcBounds += GetPoint(Extreme);
+	}
+	ArcBounds = ArcBounds.ExpandBy(1.f);
+
+	TArray<FOverlapResult> Overlaps;
+	NumQueries++;
+	World->OverlapMultiByChannel(Overlaps, ArcBounds.GetCenter(), FQuat::Identity, Channel, FCollisionShape::MakeBox(ArcBounds.GetExtent()), QueryParams);
+
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		UPrimitiveComponent* Component = Overlap.GetComponent();
+		if (Component == nullptr || Overlap.bBlockingHit == false) { continue; }
+
+		// Slice of the bounding sphere in the arc's plane
+		const FBoxSphereBounds& Bounds = Component->Bounds;
+		const float SliceRadiusSquared = FMath::Square(Bounds.SphereRadius) - FMath::Square(Bounds.Origin.X);
+		if (SliceRadiusSquared <= 0.f) { continue; }
+
+		const float SliceRadius = FMath::Sqrt(SliceRadiusSquared);
+		const float CenterDistance = FVector2D(Bounds.Origin.Y, Bounds.Origin.Z).Size();
+		if (FMath::Abs(CenterDistance - Radius) > SliceRadius) { continue; }
+
+		FCandidate Candidate;
+		Candidate.Component = Component;
+		Candidate.Center = Bounds.Origin;
+		Candidate.SphereRadius = Bounds.SphereRadius;
+		Candidate.Box = Bounds.GetBox();
+		Candidate.CenterAngle = FMath::Atan2(Bounds.Origin.Y, Bounds.Origin.Z);
+		if (CenterDistance <= SliceRadius)
+		{
+			Candidate.HalfAngle = PI;
+		}
+		else
+		{
+			// Law of cosines on the circle, the slice center and one of their intersections
+			const float CosHalfAngle = (FMath::Square(Radius) + FMath::Square(CenterDistance) - SliceRadiusSquared) / (2.f * Radius * CenterDistance);
+			Candidate.HalfAngle = FMath::Acos(FMath::Clamp(CosHalfAngle, -1.f, 1.f));
+		}
+		Candidates.Add(Candidate);
+	}
+}
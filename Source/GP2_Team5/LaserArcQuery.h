@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "CollisionQueryParams.h"
+
+//--- forward declarations ---
+class UWorld;
+class UPrimitiveComponent;
+
+/**
+ * Traces a laser arc around the world origin in the YZ plane, the plane the levels are built in.
+ * Angles follow ALightEmitter: a point is (0, Sin(Angle), Cos(Angle)) * Radius, and a positive Span runs counter clockwise.
+ * One overlap query gathers the components near the arc. Only the steps that pass close to one of them are
+ * traced, and only against that component, instead of one scene line trace per step.
+ * The step adapts to the free space around the arc: MaxStep in the open, down to MinStep next to a candidate.
+ * Candidates the arc runs inside of all the way around, like the planet, are traced on every step however long it is,
+ * so they don't shrink it.
+ */
+struct GP2_TEAM5_API FLaserArcQuery
+{
+	float Radius = 0.f;
+	float StartAngle = 0.f;
+	float Span = 0.f;
+	float MaxStep = 0.1f;
+	float MinStep = 0.1f;
+	ECollisionChannel Channel = ECC_Visibility;
+
+	// Scene and component queries made since Begin
+	int32 NumQueries = 0;
+
+	// Finds the first blocking hit along the arc. The end point of every step is appended to OutPoints,
+	// ending with the impact point on a hit. OutDirection is the direction of the step that hit.
+	// OutCandidates, if given, receives every component the arc was tested against
+	bool Trace(const UWorld* World, const FCollisionQueryParams& Params, FHitResult& OutHit, FVector& OutDirection, TArray<FVector>& OutPoints, TArray<UPrimitiveComponent*>* OutCandidates = nullptr);
+
+	// Trace split up so an arc can be spread over several frames. Begin gathers the candidates with one scene query,
+	// Step marches on until the arc hits, reaches its end or made TraceAllowance queries, and returns how many it made.
+	// A step tracing several candidates may go over the allowance. The hit is valid once IsDone and HasHit
+	void Begin(const UWorld* World, const FCollisionQueryParams& Params, TArray<UPrimitiveComponent*>* OutCandidates = nullptr);
+	int32 Step(int32 TraceAllowance, TArray<FVector>& OutPoints);
+
+	bool IsDone() const { return bDone; }
+	bool HasHit() const { return bHit; }
+	const FHitResult& GetHit() const { return Hit; }
+	const FVector& GetHitDirection() const { return HitDirection; }
+
+	FVector GetPoint(float Angle) const { return FVector(0.f, FMath::Sin(Angle) * Radius, FMath::Cos(Angle) * Radius); }
+
+protected:
+	struct FCandidate
+	{
+		// Weak, an arc in progress may outlive the component
+		TWeakObjectPtr<UPrimitiveComponent> Component;
+		FVector Center = FVector::ZeroVector;
+		float SphereRadius = 0.f;
+		FBox Box { ForceInit };
+		float CenterAngle = 0.f;
+		// Half of the angle the component's bounds cover on the circle, PI when they contain the center
+		float HalfAngle = 0.f;
+	};
+
+	void GatherCandidates(const UWorld* World);
+
+	// Conservative step (radians) from FromAngle that can't reach the bounds of any candidate. A step is free when it stays
+	// out of the candidate's angular range, or is shorter than the distance to its bounds
+	float GetFreeStep(float FromAngle, const FVector& Point) const;
+
+	TArray<FCandidate, TInlineAllocator<16>> Candidates;
+	FCollisionQueryParams QueryParams;
+
+	// Where the march is
+	float Angle = 0.f;
+	float Travelled = 0.f;
+	bool bDone = true;
+	bool bHit = false;
+	FHitResult Hit;
+	FVector HitDirection = FVector::ZeroVector;
+};
@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LaserBeamComponent.h"
+#include "UObject/ConstructorHelpers.h"
+#include "Engine/StaticMesh.h"
+#include "Materials/MaterialInstanceDynamic.h"
+
+ULaserBeamComponent::ULaserBeamComponent()
+{
+	static ConstructorHelpers::FObjectFinder<UStaticMesh> CylinderMesh(TEXT("/Engine/BasicShapes/Cylinder.Cylinder"));
+	if (CylinderMesh.Succeeded())
+	{
+		SetStaticMesh(CylinderMesh.Object);
+	}
+
+	static ConstructorHelpers::FObjectFinder<UMaterialInterface> DefaultBeamMaterial(TEXT("/Engine/BasicShapes/BasicShapeMaterial.BasicShapeMaterial"));
+	if (DefaultBeamMaterial.Succeeded())
+	{
+		BeamMaterial = DefaultBeamMaterial.Object;
+	}
+	SetMaterial(0, BeamMaterial);
+
+	SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SetGenerateOverlapEvents(false);
+	CastShadow = false;
+
+	// Keeps the beam from following its parent when attached. As a root it follows its actor,
+	// so instances are always read and written in world space
+	SetUsingAbsoluteLocation(true);
+	SetUsingAbsoluteRotation(true);
+	SetUsingAbsoluteScale(true);
+}
+
+void ULaserBeamComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (BeamMaterial == nullptr) { return; }
+
+	UMaterialInstanceDynamic* BeamInstance = CreateDynamicMaterialInstance(0, BeamMaterial);
+	if (BeamInstance != nullptr)
+	{
+		BeamInstance->SetVectorParameterValue(BeamColorParameter, BeamColor);
+	}
+}
+
+void ULaserBeamComponent::SetPath(const TArray<FVector>& Points)
+{
+	const int32 NumSegments = FMath::Max(Points.Num() - 1, 0);
+	bool bChanged = false;
+
+	// Drop instances the new path doesn't need, from the back so no other index moves
+	while (GetInstanceCount() > NumSegments)
+	{
+		RemoveInstance(GetInstanceCount() - 1);
+		bChanged = true;
+	}
+
+	for (int32 i = 0; i < NumSegments; i++)
+	{
+		const FTransform Segment = MakeSegmentTransform(Points[i], Points[i + 1]);
+		if (i >= GetInstanceCount())
+		{
+			AddInstanceWorldSpace(Segment);
+			bChanged = true;
+			continue;
+		}
+
+		FTransform Current;
+		GetInstanceTransform(i, Current, true);
+		if (Current.Equals(Segment) == false)
+		{
+			UpdateInstanceTransform(i, Segment, true, false, true);
+			bChanged = true;
+		}
+	}
+
+	if (bChanged)
+	{
+		MarkRenderStateDirty();
+	}
+}
+
+void ULaserBeamComponent::ClearPath()
+{
+	if (GetInstanceCount() == 0) { return; }
+
+	ClearInstances();
+}
+
+FTransform ULaserBeamComponent::MakeSegmentTransform(const FVector& Start, const FVector& End) const
+{
+	const FVector Delta = End - Start;
+	const float Length = Delta.Size();
+	const FQuat Rotation = Length > KINDA_SMALL_NUMBER ? FRotationMatrix::MakeFromZ(Delta / Length).ToQuat() : FQuat::Identity;
+	const float WidthScale = BeamRadius * 2.f / MeshWidth;
+	return FTransform(Rotation, (Start + End) * 0.5f, FVector(WidthScale, WidthScale, Length / MeshLength));
+}
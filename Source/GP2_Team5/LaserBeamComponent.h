@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "LaserBeamComponent.generated.h"
+
+/**
+ * Renders a laser path as one mesh instance per polyline segment.
+ * Instances are kept between updates, only segments whose transform changed are rewritten,
+ * and the render state is dirtied once per update.
+ * Instances are in world space, wherever the component itself is.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class GP2_TEAM5_API ULaserBeamComponent : public UInstancedStaticMeshComponent
+{
+	GENERATED_BODY()
+
+public:
+	ULaserBeamComponent();
+
+	virtual void BeginPlay() override;
+
+	UFUNCTION(BlueprintCallable, Category = "Laser")
+	void SetPath(const TArray<FVector>& Points);
+
+	UFUNCTION(BlueprintCallable, Category = "Laser")
+	void ClearPath();
+
+protected:
+	FTransform MakeSegmentTransform(const FVector& Start, const FVector& End) const;
+
+	/* Beam radius in cm */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Laser")
+	float BeamRadius = 1.5f;
+
+	/* Material of every segment. Defaults to the engine's basic shape material tinted with BeamColor. Assign an unlit emissive material with a BeamColorParameter for a glowing beam */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Laser")
+	class UMaterialInterface* BeamMaterial = nullptr;
+
+	/* Written to BeamColorParameter on a dynamic instance of BeamMaterial at BeginPlay */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Laser")
+	FLinearColor BeamColor = FLinearColor::Red;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Laser")
+	FName BeamColorParameter = TEXT("Color");
+
+	/* Size of the segment mesh along its Z axis. The engine cylinder is 100 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Laser")
+	float MeshLength = 100.f;
+
+	/* Size of the segment mesh across. The engine cylinder is 100 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Laser")
+	float MeshWidth = 100.f;
+};
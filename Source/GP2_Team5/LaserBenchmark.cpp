@@ -0,0 +1,323 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LaserBenchmark.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/CollisionProfile.h"
+#include "Components/StaticMeshComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/AutomationTest.h"
+#include "LaserPathSolver.h"
+
+#if LASER_BENCHMARK_ENABLED
+
+static FAutoConsoleCommand LaserBenchmarkCommand(
+	TEXT("Laser.Benchmark"),
+	TEXT("Solves synthetic laser layouts at several quantization levels and logs correctness and timings. Optional argument: iterations"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FLaserBenchmark::Run(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 200);
+	}));
+
+// A 100cm cube of the layout
+struct FLaserBenchmarkBlock
+{
+	FVector Location = FVector::ZeroVector;
+	FQuat Rotation = FQuat::Identity;
+	FVector Scale = FVector::OneVector;
+};
+
+// Where a segment of the path must end, worked out by hand from the layout
+struct FLaserBenchmarkExpectedSegment
+{
+	int32 Segment = 0;
+	FVector End = FVector::ZeroVector;
+	// Zero when the segment ends on nothing
+	FVector Normal = FVector::ZeroVector;
+	// Chords of an arc cut inside the circle and tilt the reflection, so later segments get more slack
+	float Tolerance = 2.f;
+};
+
+struct FLaserBenchmarkLayout
+{
+	const TCHAR* Name = TEXT("");
+	TArray<FLaserBenchmarkBlock> Blocks;
+	FLaserSolveParams Params;
+
+	// What the path must produce at every quantization level, INDEX_NONE when it isn't fixed
+	int32 ExpectedSegments = INDEX_NONE;
+	// Block the first segment has to end on, INDEX_NONE for none
+	int32 ExpectedFirstHit = INDEX_NONE;
+	TArray<FLaserBenchmarkExpectedSegment> ExpectedEnds;
+};
+
+static constexpr float NormalTolerance = 0.001f;
+
+static const float BenchmarkQuantizationLevels[] = { 0.02f, 0.05f, 0.1f, 0.2f, 0.4f };
+
+static FVector OnCircle(float Radius, float Angle)
+{
+	return FVector(0.f, FMath::Sin(Angle) * Radius, FMath::Cos(Angle) * Radius);
+}
+
+// Square room around the origin. Every circle that leaves it crosses a wall, so every segment ends on a hit
+static void AddEnclosure(FLaserBenchmarkLayout& Layout, float HalfSize)
+{
+	const float Thickness = 20.f;
+	const float Length = 2.f * (HalfSize + Thickness);
+	const float Offset = HalfSize + Thickness * 0.5f;
+	for (float Side : { -1.f, 1.f })
+	{
+		Layout.Blocks.Add({ FVector(0.f, Side * Offset, 0.f), FQuat::Identity, FVector(1.f, Thickness, Length) / 100.f });
+		Layout.Blocks.Add({ FVector(0.f, 0.f, Side * Offset), FQuat::Identity, FVector(1.f, Length, Thickness) / 100.f });
+	}
+}
+
+static TArray<FLaserBenchmarkLayout> MakeLayouts()
+{
+	TArray<FLaserBenchmarkLayout> Layouts;
+
+	FLaserSolveParams Params;
+	Params.Start = OnCircle(500.f, 0.f);
+	Params.bCCW = true;
+
+	{
+		FLaserBenchmarkLayout& Layout = Layouts.AddDefaulted_GetRef();
+		Layout.Name = TEXT("OpenArc");
+		Layout.Params = Params;
+		Layout.ExpectedSegments = 1;
+		// The whole span, 1.9 PI around
+		Layout.ExpectedEnds.Add({ 0, FVector(0.f, -154.51f, 475.53f) });
+	}
+	{
+		// One mirror on the arc, the reflection leaves into empty space
+		FLaserBenchmarkLayout& Layout = Layouts.AddDefaulted_GetRef();
+		Layout.Name = TEXT("ArcToStraight");
+		Layout.Blocks.Add({ OnCircle(500.f, 0.6f) });
+		Layout.Params = Params;
+		Layout.ExpectedSegments = 2;
+		Layout.ExpectedFirstHit = 0;
+		// The arc enters the cube through its -Y face at angle 0.4832, and the reflection runs off along (0, -Cos, -Sin) of it
+		Layout.ExpectedEnds.Add({ 0, FVector(0.f, 232.32f, 442.75f), FVector(0.f, -1.f, 0.f) });
+		Layout.ExpectedEnds.Add({ 1, FVector(0.f, -653.18f, -21.89f), FVector::ZeroVector, 25.f });
+	}
+	for (int32 MaxBounces : { 4, MaxLaserBounces })
+	{
+		// A mirror kicks the beam out against the walls of a room, where it bounces until MaxBounces runs out
+		FLaserBenchmarkLayout& Layout = Layouts.AddDefaulted_GetRef();
+		Layout.Name = MaxBounces == MaxLaserBounces ? TEXT("SaturateMax") : TEXT("Saturate4");
+		Layout.Blocks.Add({ OnCircle(500.f, 0.6f) });
+		AddEnclosure(Layout, 1500.f);
+		Layout.Params = Params;
+		Layout.Params.StraightLength = 5000.f;
+		Layout.Params.MaxBounces = MaxBounces;
+		Layout.ExpectedSegments = MaxBounces + 1;
+		Layout.ExpectedFirstHit = 0;
+		Layout.ExpectedEnds.Add({ 0, FVector(0.f, 232.32f, 442.75f), FVector(0.f, -1.f, 0.f) });
+	}
+	{
+		// A face facing the origin that the arc only cuts by half a centimeter
+		const float Angle = 0.8f;
+		FLaserBenchmarkLayout& Layout = Layouts.AddDefaulted_GetRef();
+		Layout.Name = TEXT("Grazing");
+		Layout.Blocks.Add({ OnCircle(550.f - 0.5f, Angle), FQuat(FVector::ForwardVector, -Angle) });
+		Layout.Params = Params;
+		Layout.ExpectedFirstHit = 0;
+		// The face is 499.5 from the origin, the arc crosses it 0.0447 before Angle
+		Layout.ExpectedEnds.Add({ 0, FVector(0.f, 342.74f, 364.04f), FVector(0.f, -0.7174f, -0.6967f) });
+	}
+	return Layouts;
+}
+
+// Solves the path once and returns the number of scene queries it took
+static int32 SolveOnce(const UWorld* World, FLaserPathSolver& Solver, const FLaserSolveParams& Params)
+{
+	Solver.Begin(Params);
+	return Solver.Step(World, MAX_int32);
+}
+
+// Empty when the path passes, the reason it failed otherwise
+static FString CheckPath(const FLaserBenchmarkLayout& Layout, const TArray<AActor*>& Blocks, const FLaserPathSolver& Solver)
+{
+	const FLaserSegmentBuffer& Segments = Solver.Segments;
+	if (Segments.Num() == 0 || Segments.Num() > Layout.Params.MaxBounces + 1)
+	{
+		return FString::Printf(TEXT("%d segments, at most %d allowed"), Segments.Num(), Layout.Params.MaxBounces + 1);
+	}
+	if (Layout.ExpectedSegments != INDEX_NONE && Segments.Num() != Layout.ExpectedSegments)
+	{
+		return FString::Printf(TEXT("%d segments, expected %d"), Segments.Num(), Layout.ExpectedSegments);
+	}
+
+	const UPrimitiveComponent* FirstHit = Segments[0].HitComponent;
+	const AActor* ExpectedActor = Blocks.IsValidIndex(Layout.ExpectedFirstHit) ? Blocks[Layout.ExpectedFirstHit] : nullptr;
+	if ((FirstHit != nullptr ? FirstHit->GetOwner() : nullptr) != ExpectedActor)
+	{
+		return FString::Printf(TEXT("first segment ended on %s, expected %s"), FirstHit != nullptr ? *FirstHit->GetOwner()->GetName() : TEXT("nothing"), ExpectedActor != nullptr ? *ExpectedActor->GetName() : TEXT("nothing"));
+	}
+
+	for (const FLaserBenchmarkExpectedSegment& Expected : Layout.ExpectedEnds)
+	{
+		if (Segments.IsValidIndex(Expected.Segment) == false) { continue; }
+
+		const FLaserSegment& Segment = Segments[Expected.Segment];
+		const float Error = FVector::Dist(Segment.End, Expected.End);
+		if (Error > Expected.Tolerance)
+		{
+			return FString::Printf(TEXT("segment %d ends at %s, %.2fcm away from %s"), Expected.Segment, *Segment.End.ToString(), Error, *Expected.End.ToString());
+		}
+		if (Segment.HitNormal.Equals(Expected.Normal, NormalTolerance) == false)
+		{
+			return FString::Printf(TEXT("segment %d has hit normal %s, expected %s"), Expected.Segment, *Segment.HitNormal.ToString(), *Expected.Normal.ToString());
+		}
+	}
+
+	for (const FLaserSegment& Segment : Segments)
+	{
+		if (Segment.NumPoints < 2 || Segment.FirstPoint + Segment.NumPoints > Solver.Points.Num())
+		{
+			return TEXT("segment points out of range");
+		}
+		if (Solver.Points[Segment.FirstPoint].Equals(Segment.Start) == false || Solver.Points[Segment.FirstPoint + Segment.NumPoints - 1].Equals(Segment.End) == false)
+		{
+			return TEXT("segment ends don't match its points");
+		}
+	}
+	return FString();
+}
+
+static bool RunLayout(UWorld* World, UStaticMesh* Cube, const FLaserBenchmarkLayout& Layout, int32 Iterations, TArray<FString>* OutFailures)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	TArray<AActor*> Blocks;
+	for (const FLaserBenchmarkBlock& Block : Layout.Blocks)
+	{
+		AStaticMeshActor* Actor = World->SpawnActor<AStaticMeshActor>(Block.Location, Block.Rotation.Rotator(), SpawnParams);
+		UStaticMeshComponent* Mesh = Actor->GetStaticMeshComponent();
+		Mesh->SetMobility(EComponentMobility::Movable);
+		Mesh->SetStaticMesh(Cube);
+		Mesh->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+		Actor->SetActorScale3D(Block.Scale);
+		Blocks.Add(Actor);
+	}
+
+	bool bPassed = true;
+	FLaserPathSolver Solver;
+	for (float QuantizationLevel : BenchmarkQuantizationLevels)
+	{
+		FLaserSolveParams Params = Layout.Params;
+		Params.QuantizationLevel = QuantizationLevel;
+		Params.MinQuantizationLevel = FMath::Min(Params.MinQuantizationLevel, QuantizationLevel);
+
+		const int32 NumTraces = SolveOnce(World, Solver, Params);
+		const FString Failure = CheckPath(Layout, Blocks, Solver);
+
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		for (int32 i = 0; i < Iterations; i++)
+		{
+			SolveOnce(World, Solver, Params);
+		}
+		const double Microseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000.0 / FMath::Max(Iterations, 1);
+
+		if (Failure.IsEmpty())
+		{
+			UE_LOG(LogTemp, Log, TEXT("Laser.Benchmark %-14s Q=%.3f  %2d segments  %4d points  %4d traces  %8.2fus  ok"),
+				Layout.Name, QuantizationLevel, Solver.Segments.Num(), Solver.Points.Num(), NumTraces, Microseconds);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Error, TEXT("Laser.Benchmark %-14s Q=%.3f  %2d segments  %4d points  %4d traces  %8.2fus  FAILED: %s"),
+				Layout.Name, QuantizationLevel, Solver.Segments.Num(), Solver.Points.Num(), NumTraces, Microseconds, *Failure);
+			if (OutFailures != nullptr)
+			{
+				OutFailures->Add(FString::Printf(TEXT("%s at Q=%.3f: %s"), Layout.Name, QuantizationLevel, *Failure));
+			}
+			bPassed = false;
+		}
+	}
+
+	for (AActor* Block : Blocks)
+	{
+		Block->Destroy();
+	}
+	return bPassed;
+}
+
+bool FLaserBenchmark::Run(int32 Iterations, TArray<FString>* OutFailures)
+{
+	UStaticMesh* Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	if (Cube == nullptr || GEngine == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Laser.Benchmark couldn't load the cube mesh"));
+		if (OutFailures != nullptr)
+		{
+			OutFailures->Add(TEXT("couldn't load the cube mesh"));
+		}
+		return false;
+	}
+
+	// A world of its own so the loaded level stays out of the paths
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("LaserBenchmark"));
+	FWorldContext& Context = GEngine->CreateNewWorldContext(EWorldType::Game);
+	Context.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+
+	int32 NumPassed = 0;
+	const TArray<FLaserBenchmarkLayout> Layouts = MakeLayouts();
+	for (const FLaserBenchmarkLayout& Layout : Layouts)
+	{
+		NumPassed += RunLayout(World, Cube, Layout, Iterations, OutFailures) ? 1 : 0;
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	UE_LOG(LogTemp, Log, TEXT("Laser.Benchmark %d of %d layouts passed"), NumPassed, Layouts.Num());
+	return NumPassed == Layouts.Num();
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLaserPathSolverTest, "GP2_Team5.Laser.PathSolver", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FLaserPathSolverTest::RunTest(const FString& Parameters)
+{
+	TArray<FString> Failures;
+	FLaserBenchmark::Run(0, &Failures);
+	for (const FString& Failure : Failures)
+	{
+		AddError(Failure);
+	}
+	return Failures.Num() == 0;
+}
+
+// The timing report of Laser.Benchmark, checked the same way
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLaserPathSolverBenchmarkTest, "GP2_Team5.Laser.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FLaserPathSolverBenchmarkTest::RunTest(const FString& Parameters)
+{
+	TArray<FString> Failures;
+	FLaserBenchmark::Run(200, &Failures);
+	for (const FString& Failure : Failures)
+	{
+		AddError(Failure);
+	}
+	return Failures.Num() == 0;
+}
+
+#endif
+
+#else
+
+bool FLaserBenchmark::Run(int32 Iterations, TArray<FString>* OutFailures)
+{
+	return true;
+}
+
+#endif
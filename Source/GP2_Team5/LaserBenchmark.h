@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// The benchmark is a development tool and is compiled out of Shipping builds
+#define LASER_BENCHMARK_ENABLED !UE_BUILD_SHIPPING
+
+/**
+ * Correctness and performance check for FLaserPathSolver.
+ * Builds small synthetic mirror layouts in a world of their own, so the loaded level can't interfere, and solves each
+ * one at several QuantizationLevel values. Every path is checked against what its layout must produce, down to end points
+ * and hit normals worked out by hand. Traces per path and microseconds per solve are logged next to the result.
+ * The checks run as the GP2_Team5.Laser.PathSolver automation test, the timings with the Laser.Benchmark console command
+ * or the GP2_Team5.Laser.Benchmark performance test, also headless: -nullrhi -ExecCmds="Automation RunTests GP2_Team5.Laser"
+ */
+struct GP2_TEAM5_API FLaserBenchmark
+{
+	// Solves every path Iterations times for the timing. Returns true when every check passed, and adds the reason
+	// of every failed check to OutFailures if given
+	static bool Run(int32 Iterations, TArray<FString>* OutFailures = nullptr);
+};
@@ -0,0 +1,159 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LaserPathSolver.h"
+#include "Engine/World.h"
+#include "Components/PrimitiveComponent.h"
+#include "InteractionTrace.h"
+
+void FLaserPathSolver::Begin(const FLaserSolveParams& InParams)
+{
+	Segments.Reset();
+	Points.Reset();
+	Touched.Reset();
+
+	Params = InParams;
+	Params.MaxBounces = FMath::Clamp(Params.MaxBounces, 0, MaxLaserBounces);
+	Start = Params.Start;
+	Direction = FVector::ZeroVector;
+	bCCW = Params.bCCW;
+	Type = ELaserSegmentType::Arc;
+	Bounce = 0;
+	bDone = false;
+	bInSegment = false;
+
+	// Drops an arc left in progress by the previous path
+	Arc = FLaserArcQuery();
+
+	Points.Add(Start);
+}
+
+void FLaserPathSolver::Solve(const UWorld* World, const FLaserSolveParams& InParams)
+{
+	Begin(InParams);
+	Step(World, MAX_int32);
+}
+
+int32 FLaserPathSolver::Step(const UWorld* World, int32 TraceAllowance)
+{
+	int32 NumTraces = 0;
+	if (World == nullptr)
+	{
+		bDone = true;
+		return NumTraces;
+	}
+
+	while (bDone == false && (NumTraces == 0 || NumTraces < TraceAllowance))
+	{
+		if (bInSegment == false)
+		{
+			FLaserSegment& NewSegment = Segments.AddDefaulted_GetRef();
+			NewSegment.Type = Type;
+			NewSegment.Start = Start;
+			NewSegment.FirstPoint = Points.Num() - 1;
+			bInSegment = true;
+		}
+		FLaserSegment& Segment = Segments.Last();
+
+		const bool bContinue = Type == ELaserSegmentType::Arc
+			? SolveArc(World, Segment, TraceAllowance - NumTraces, NumTraces)
+			: SolveStraight(World, Segment, NumTraces);
+
+		// Out of allowance part way through the arc, it carries on from there next time
+		if (Type == ELaserSegmentType::Arc && Arc.IsDone() == false) { continue; }
+
+		bInSegment = false;
+		Segment.End = Points.Last();
+		Segment.NumPoints = Points.Num() - Segment.FirstPoint;
+
+		// Arcs reflect into straight lines and straight lines bend back into arcs
+		Type = Type == ELaserSegmentType::Arc ? ELaserSegmentType::Straight : ELaserSegmentType::Arc;
+		bDone = bContinue == false || ++Bounce > Params.MaxBounces;
+	}
+	return NumTraces;
+}
+
+bool FLaserPathSolver::SolveArc(const UWorld* World, FLaserSegment& Segment, int32 TraceAllowance, int32& NumTraces)
+{
+	// A new arc, rather than one resumed
+	if (Arc.IsDone())
+	{
+		Arc.Radius = Start.Size();
+		Arc.StartAngle = FMath::Atan2(Start.Y, Start.Z);
+		Arc.Span = bCCW ? Params.ArcSpan : -Params.ArcSpan;
+		Arc.MaxStep = Params.QuantizationLevel;
+		Arc.MinStep = Params.MinQuantizationLevel;
+		Arc.Channel = Params.Channel;
+		ArcCandidates.Reset();
+		Arc.Begin(World, FCollisionQueryParams(SCENE_QUERY_STAT(LaserArc), false), &ArcCandidates);
+		for (UPrimitiveComponent* Candidate : ArcCandidates)
+		{
+			Touch(Candidate);
+		}
+		NumTraces += Arc.NumQueries;
+		TraceAllowance -= Arc.NumQueries;
+	}
+
+	NumTraces += Arc.Step(TraceAllowance, Points);
+	if (Arc.IsDone() == false) { return true; }
+	if (Arc.HasHit() == false) { return false; }
+
+	const FHitResult& Hit = Arc.GetHit();
+	const FVector HitStepDirection = Arc.GetHitDirection();
+	Segment.HitComponent = Hit.GetComponent();
+	Segment.HitNormal = Hit.Normal;
+
+	// Reflect the arc's tangent at the hit
+	const FVector Incidence = -HitStepDirection;
+	Direction = FQuat::FindBetweenNormals(Incidence, Hit.Normal) * Hit.Normal;
+	Start = Hit.ImpactPoint;
+	return true;
+}
+
+bool FLaserPathSolver::SolveStraight(const UWorld* World, FLaserSegment& Segment, int32& NumTraces)
+{
+	const FVector End = Start + Params.StraightLength * Direction;
+
+	FHitResult Hit;
+	NumTraces++;
+	if (World->LineTraceSingleByChannel(Hit, Start, End, Params.Channel) == false)
+	{
+		Points.Add(End);
+		return false;
+	}
+
+	Points.Add(Hit.ImpactPoint);
+	Touch(Hit.GetComponent());
+	Segment.HitComponent = Hit.GetComponent();
+	Segment.HitNormal = Hit.Normal;
+
+	// Which way around the origin the surface sends the beam
+	const FVector HitDirection = FVector::CrossProduct(Hit.ImpactPoint, Hit.Normal);
+	bCCW = HitDirection.X <= 0.f;
+	if (bCCW)
+	{
+		INTERACTION_TRACE(LaserStraight, BounceCCW, Params.Emitter, Hit.GetActor());
+	}
+	else
+	{
+		INTERACTION_TRACE(LaserStraight, BounceCW, Params.Emitter, Hit.GetActor());
+	}
+
+	Start = Hit.ImpactPoint;
+	return true;
+}
+
+void FLaserPathSolver::Touch(UPrimitiveComponent* Component)
+{
+	if (Component == nullptr) { return; }
+
+	for (const FLaserWatchedComponent& Watched : Touched)
+	{
+		if (Watched.Component.Get() == Component) { return; }
+	}
+
+	FLaserWatchedComponent& Watched = Touched.AddDefaulted_GetRef();
+	Watched.Component = Component;
+	Watched.Transform = Component->GetComponentTransform();
+	Watched.CollisionEnabled = Component->GetCollisionEnabled();
+}
@@ -0,0 +1,146 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "Enums.h"
+#include "LaserArcQuery.h"
+#include "LaserPathSolver.generated.h"
+
+//--- forward declarations ---
+class UWorld;
+class UPrimitiveComponent;
+
+// Upper bound of ALightEmitter::MaxBounces. A path has at most one segment per bounce plus the first one
+static constexpr int32 MaxLaserBounces = 12;
+static constexpr int32 MaxLaserSegments = MaxLaserBounces + 1;
+
+// One arc or straight piece of a laser path, from where it starts to where it hit or gave up
+USTRUCT(BlueprintType)
+struct FLaserSegment
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Laser")
+	ELaserSegmentType Type = ELaserSegmentType::Straight;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Laser")
+	FVector Start = FVector::ZeroVector;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Laser")
+	FVector End = FVector::ZeroVector;
+
+	/* Component the segment ended on, nullptr if it hit nothing */
+	UPROPERTY(BlueprintReadOnly, Category = "Laser")
+	UPrimitiveComponent* HitComponent = nullptr;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Laser")
+	FVector HitNormal = FVector::ZeroVector;
+
+	/* First point of the segment in FLaserPath::Points. Arcs span several points */
+	UPROPERTY(BlueprintReadOnly, Category = "Laser")
+	int32 FirstPoint = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Laser")
+	int32 NumPoints = 0;
+};
+
+USTRUCT(BlueprintType)
+struct FLaserPath
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Laser")
+	TArray<FLaserSegment> Segments;
+
+	/* The whole path as one polyline */
+	UPROPERTY(BlueprintReadOnly, Category = "Laser")
+	TArray<FVector> Points;
+
+	void Reset()
+	{
+		Segments.Reset();
+		Points.Reset();
+	}
+};
+
+using FLaserSegmentBuffer = TArray<FLaserSegment, TInlineAllocator<MaxLaserSegments>>;
+
+// A component the laser path was traced against, and its state when it was traced
+struct FLaserWatchedComponent
+{
+	TWeakObjectPtr<UPrimitiveComponent> Component;
+	FTransform Transform;
+	ECollisionEnabled::Type CollisionEnabled = ECollisionEnabled::NoCollision;
+};
+
+struct FLaserSolveParams
+{
+	FVector Start = FVector::ZeroVector;
+	bool bCCW = false;
+	// Arc step in radians in open space, and the smallest step next to geometry
+	float QuantizationLevel = 0.1f;
+	float MinQuantizationLevel = 0.02f;
+	float ArcSpan = 1.9f * PI;
+	float StraightLength = 1000.f;
+	int32 MaxBounces = MaxLaserBounces;
+	ECollisionChannel Channel = ECC_Visibility;
+
+	// Reported as the source of trace records
+	const UObject* Emitter = nullptr;
+};
+
+/**
+ * Follows a laser through its bounces: an arc around the world origin until it hits something,
+ * then a straight reflection, then an arc again, and so on.
+ * Runs as a loop over a fixed-capacity segment buffer and can be stopped part way through an arc and resumed later,
+ * so a path can be spread over several frames. The buffers are kept between solves, so solving doesn't reallocate them.
+ */
+struct GP2_TEAM5_API FLaserPathSolver
+{
+public:
+	// Starts a new path, dropping whatever was solved before
+	void Begin(const FLaserSolveParams& InParams);
+
+	// Solves until the path ends or TraceAllowance scene queries were made. Goes over the allowance by at most
+	// the queries of one arc step. Returns the number of queries made
+	int32 Step(const UWorld* World, int32 TraceAllowance);
+
+	// Begin and Step in one go
+	void Solve(const UWorld* World, const FLaserSolveParams& InParams);
+
+	bool IsDone() const { return bDone; }
+
+	// Output, valid once IsDone. Touched is every component the path was traced against, as it was when traced.
+	// A path spread over several frames may have traced some of them before they moved
+	FLaserSegmentBuffer Segments;
+	TArray<FVector> Points;
+	TArray<FLaserWatchedComponent> Touched;
+
+private:
+	// Both return false when the path ends, and advance the solver to the next segment on a hit.
+	// SolveArc also returns true while Arc is still in progress
+	bool SolveArc(const UWorld* World, FLaserSegment& Segment, int32 TraceAllowance, int32& NumTraces);
+	bool SolveStraight(const UWorld* World, FLaserSegment& Segment, int32& NumTraces);
+
+	// Adds Component to Touched with its current transform, unless it is there already
+	void Touch(UPrimitiveComponent* Component);
+
+	FLaserSolveParams Params;
+
+	// Where the next segment starts
+	FVector Start = FVector::ZeroVector;
+	FVector Direction = FVector::ZeroVector;
+	bool bCCW = false;
+	ELaserSegmentType Type = ELaserSegmentType::Arc;
+	int32 Bounce = 0;
+	bool bDone = true;
+
+	// The arc being traced when Step ran out of allowance
+	FLaserArcQuery Arc;
+	bool bInSegment = false;
+
+	// Reused for the candidates of each arc
+	TArray<UPrimitiveComponent*> ArcCandidates;
+};
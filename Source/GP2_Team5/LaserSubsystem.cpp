@@ -0,0 +1,311 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LaserSubsystem.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "Async/ParallelFor.h"
+#include "Components/PrimitiveComponent.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "LightEmitter.h"
+#include "LightReceiverComponent.h"
+
+DECLARE_STATS_GROUP(TEXT("Laser"), STATGROUP_Laser, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Solve Emitters"), STAT_LaserSolveEmitters, STATGROUP_Laser);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Traces"), STAT_LaserTraces, STATGROUP_Laser);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Trace Budget"), STAT_LaserTraceBudget, STATGROUP_Laser);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Emitters Solved"), STAT_LaserEmittersSolved, STATGROUP_Laser);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Stale Emitters"), STAT_LaserStaleEmitters, STATGROUP_Laser);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Most Frames Stale"), STAT_LaserMostFramesStale, STATGROUP_Laser);
+
+static FAutoConsoleCommandWithWorld DumpLaserStatsCommand(
+	TEXT("Laser.DumpStats"),
+	TEXT("Logs how stale every laser emitter's path is and how many traces it took"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const ULaserSubsystem* Lasers = ULaserSubsystem::Get(World))
+		{
+			Lasers->DumpStats();
+		}
+	}));
+
+void FLaserTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Subsystem != nullptr)
+	{
+		Subsystem->SolveEmitters();
+	}
+}
+
+FString FLaserTickFunction::DiagnosticMessage()
+{
+	return TEXT("ULaserSubsystem::SolveEmitters");
+}
+
+void ULaserSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	TickFunction.bCanEverTick = true;
+	TickFunction.bStartWithTickEnabled = true;
+	TickFunction.TickGroup = TG_PostPhysics;
+	TickFunction.Subsystem = this;
+}
+
+void ULaserSubsystem::Deinitialize()
+{
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+	TickFunction.Subsystem = nullptr;
+
+	Emitters.Reset();
+	Scheduled.Reset();
+	ReceiversByOwner.Reset();
+	EmitterHits.Reset();
+
+	Super::Deinitialize();
+}
+
+ULaserSubsystem* ULaserSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject != nullptr ? WorldContextObject->GetWorld() : nullptr;
+	if (World == nullptr || World->IsGameWorld() == false) { return nullptr; }
+
+	return World->GetSubsystem<ULaserSubsystem>();
+}
+
+void ULaserSubsystem::RegisterEmitter(ALightEmitter* Emitter)
+{
+	if (Emitter == nullptr) { return; }
+
+	// Registered lazily since the persistent level isn't guaranteed to exist when the subsystem initializes
+	if (TickFunction.IsTickFunctionRegistered() == false && GetWorld()->PersistentLevel != nullptr)
+	{
+		TickFunction.RegisterTickFunction(GetWorld()->PersistentLevel);
+	}
+
+	Emitters.AddUnique(Emitter);
+}
+
+void ULaserSubsystem::UnregisterEmitter(ALightEmitter* Emitter)
+{
+	Emitters.RemoveSwap(Emitter);
+}
+
+void ULaserSubsystem::SolveEmitters()
+{
+	SCOPE_CYCLE_COUNTER(STAT_LaserSolveEmitters);
+	SET_DWORD_STAT(STAT_LaserTraceBudget, TraceBudget);
+
+	const APawn* Player = UGameplayStatics::GetPlayerPawn(this, 0);
+	const FVector PlayerLocation = Player != nullptr ? Player->GetActorLocation() : FVector::ZeroVector;
+
+	// Paths still in progress, and paths that went out of date
+	Scheduled.Reset();
+	for (ALightEmitter* Emitter : Emitters)
+	{
+		if (Emitter->IsSolving() || Emitter->IsPathDirty())
+		{
+			FScheduledEmitter& Entry = Scheduled.AddDefaulted_GetRef();
+			Entry.Emitter = Emitter;
+			Entry.Priority = GetSchedulePriority(Emitter, PlayerLocation);
+			Entry.bUrgent = IsUrgent(Emitter);
+		}
+	}
+	if (Scheduled.Num() == 0) { return; }
+
+	Scheduled.Sort([](const FScheduledEmitter& A, const FScheduledEmitter& B)
+	{
+		return A.bUrgent != B.bUrgent ? A.bUrgent : A.Priority < B.Priority;
+	});
+
+	// Hand the budget out in slices. The first emitter always gets one, so a tiny budget still makes progress
+	int32 RemainingBudget = TraceBudget;
+	int32 NumSolving = 0;
+	for (FScheduledEmitter& Entry : Scheduled)
+	{
+		if (RemainingBudget <= 0 && NumSolving > 0) { break; }
+
+		if (Entry.Emitter->IsSolving() == false)
+		{
+			Entry.Emitter->BeginSolve();
+		}
+		Entry.TraceAllowance = FMath::Max(FMath::Min(TracesPerSlice, RemainingBudget), 1);
+		RemainingBudget -= Entry.TraceAllowance;
+		NumSolving++;
+	}
+
+	// Each emitter only writes its own buffers. Nothing moves in the scene until the loop is done
+	ParallelFor(NumSolving, [this](int32 Index)
+	{
+		FScheduledEmitter& Entry = Scheduled[Index];
+		Entry.TracesUsed = Entry.Emitter->Solve(Entry.TraceAllowance);
+	}, NumSolving < 2);
+
+	// Listeners of an earlier emitter may destroy a later one
+	int32 NumTraces = 0;
+	int32 NumSolved = 0;
+	int32 NumStale = 0;
+	int32 MostFramesStale = 0;
+	for (int32 i = 0; i < Scheduled.Num(); i++)
+	{
+		ALightEmitter* Emitter = Scheduled[i].Emitter;
+		NumTraces += Scheduled[i].TracesUsed;
+		if (IsValid(Emitter) == false) { continue; }
+
+		if (i < NumSolving && Emitter->IsSolving() == false)
+		{
+			Emitter->FinishSolve();
+			NumSolved++;
+		}
+		else
+		{
+			Emitter->FramesStale++;
+			NumStale++;
+			MostFramesStale = FMath::Max(MostFramesStale, Emitter->FramesStale);
+		}
+	}
+
+	SET_DWORD_STAT(STAT_LaserTraces, NumTraces);
+	SET_DWORD_STAT(STAT_LaserEmittersSolved, NumSolved);
+	SET_DWORD_STAT(STAT_LaserStaleEmitters, NumStale);
+	SET_DWORD_STAT(STAT_LaserMostFramesStale, MostFramesStale);
+}
+
+float ULaserSubsystem::GetSchedulePriority(const ALightEmitter* Emitter, const FVector& PlayerLocation) const
+{
+	// Nearer goes first, and waiting brings an emitter closer
+	const float Distance = FVector::Dist(Emitter->GetActorLocation(), PlayerLocation);
+	return Distance / (1.f + Emitter->FramesStale);
+}
+
+bool ULaserSubsystem::IsUrgent(const ALightEmitter* Emitter) const
+{
+	return Emitter->WasRecentlyRendered() || Emitter->FramesStale >= MaxStaleFrames;
+}
+
+void ULaserSubsystem::DumpStats() const
+{
+	UE_LOG(LogTemp, Log, TEXT("Laser budget %d traces per frame, %d per slice, %d emitters"), TraceBudget, TracesPerSlice, Emitters.Num());
+	for (const ALightEmitter* Emitter : Emitters)
+	{
+		UE_LOG(LogTemp, Log, TEXT("  %s: %d frames stale, %d traces, %d segments%s%s"),
+			*Emitter->GetName(), Emitter->FramesStale, Emitter->PathTraces, Emitter->GetLaserPath().Segments.Num(),
+			Emitter->IsSolving() ? TEXT(", solving") : TEXT(""),
+			Emitter->WasRecentlyRendered() ? TEXT(", on screen") : TEXT(""));
+	}
+}
+
+void ULaserSubsystem::RegisterReceiver(ULightReceiverComponent* Receiver)
+{
+	if (Receiver == nullptr || Receiver->GetOwner() == nullptr) { return; }
+
+	AActor* Owner = Receiver->GetOwner();
+	ReceiversByOwner.Add(Owner, Receiver);
+
+	// A receiver that begins play inside a beam is lit by paths solved before it existed
+	TArray<ALightEmitter*, TInlineAllocator<8>> Touching;
+	for (ALightEmitter* Emitter : Emitters)
+	{
+		for (const FLaserSegment& Segment : Emitter->GetLaserPath().Segments)
+		{
+			if (Segment.HitComponent != nullptr && Segment.HitComponent->GetOwner() == Owner)
+			{
+				Touching.Add(Emitter);
+				break;
+			}
+		}
+	}
+
+	// Listeners may destroy emitters
+	for (ALightEmitter* Emitter : Touching)
+	{
+		if (IsValid(Emitter))
+		{
+			UpdateEmitterHits(Emitter, Emitter->GetLaserPath());
+		}
+	}
+}
+
+void ULaserSubsystem::UnregisterReceiver(ULightReceiverComponent* Receiver)
+{
+	if (Receiver == nullptr) { return; }
+
+	ReceiversByOwner.Remove(Receiver->GetOwner());
+
+	// No exit event, the receiver is going away
+	for (auto& Pair : EmitterHits)
+	{
+		Pair.Value.Remove(Receiver);
+	}
+}
+
+ULightReceiverComponent* ULaserSubsystem::FindReceiver(const AActor* Actor) const
+{
+	ULightReceiverComponent* const* Receiver = ReceiversByOwner.Find(Actor);
+	return Receiver != nullptr ? *Receiver : nullptr;
+}
+
+void ULaserSubsystem::UpdateEmitterHits(ALightEmitter* Emitter, const FLaserPath& Path)
+{
+	if (Emitter == nullptr) { return; }
+
+	TArray<ULightReceiverComponent*, TInlineAllocator<4>> NewHits;
+	if (ReceiversByOwner.Num() > 0)
+	{
+		for (const FLaserSegment& Segment : Path.Segments)
+		{
+			if (Segment.HitComponent == nullptr) { continue; }
+
+			if (ULightReceiverComponent* Receiver = FindReceiver(Segment.HitComponent->GetOwner()))
+			{
+				NewHits.AddUnique(Receiver);
+			}
+		}
+	}
+
+	SetEmitterHits(Emitter, NewHits);
+}
+
+void ULaserSubsystem::ClearEmitterHits(ALightEmitter* Emitter)
+{
+	SetEmitterHits(Emitter, {});
+	EmitterHits.Remove(Emitter);
+}
+
+void ULaserSubsystem::SetEmitterHits(ALightEmitter* Emitter, const TArray<ULightReceiverComponent*, TInlineAllocator<4>>& NewHits)
+{
+	TArray<ULightReceiverComponent*, TInlineAllocator<4>>& OldHits = EmitterHits.FindOrAdd(Emitter);
+
+	// Copied first, listeners may change the hits of this emitter while being notified
+	TArray<ULightReceiverComponent*, TInlineAllocator<4>> Exited;
+	TArray<ULightReceiverComponent*, TInlineAllocator<4>> Entered;
+	for (ULightReceiverComponent* Receiver : OldHits)
+	{
+		if (NewHits.Contains(Receiver) == false)
+		{
+			Exited.Add(Receiver);
+		}
+	}
+	for (ULightReceiverComponent* Receiver : NewHits)
+	{
+		if (OldHits.Contains(Receiver) == false)
+		{
+			Entered.Add(Receiver);
+		}
+	}
+	OldHits = NewHits;
+
+	for (ULightReceiverComponent* Receiver : Exited)
+	{
+		Receiver->RemoveEmitter(Emitter);
+	}
+	for (ULightReceiverComponent* Receiver : Entered)
+	{
+		Receiver->AddEmitter(Emitter);
+	}
+}
@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineBaseTypes.h"
+#include "LaserPathSolver.h"
+#include "LaserSubsystem.generated.h"
+
+//--- forward declarations ---
+class ALightEmitter;
+class ULightReceiverComponent;
+class ULaserSubsystem;
+
+// Advances the emitters' paths once per frame after physics
+struct FLaserTickFunction : public FTickFunction
+{
+	ULaserSubsystem* Subsystem = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+/**
+ * Solves the paths of all light emitters in one pass after physics.
+ * Dirty emitters are collected on the game thread, their paths are traced in a ParallelFor while the game thread
+ * waits, so the physics scene is only read, and the results are published on the game thread.
+ * The pass spends at most TraceBudget scene queries per frame. Emitters on screen or near the player get their share
+ * first, a path that runs out of budget carries on from where it stopped next frame, and emitters left waiting
+ * move up the order so none of them starves. "stat Laser" and Laser.DumpStats show where the budget goes.
+ * Also keeps track of which light receivers each emitter's path hits, and tells receivers when light
+ * starts or stops reaching them. A receiver hit by several emitters is lit until the last one leaves.
+ */
+UCLASS()
+class GP2_TEAM5_API ULaserSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	static ULaserSubsystem* Get(const UObject* WorldContextObject);
+
+	void RegisterEmitter(ALightEmitter* Emitter);
+	void UnregisterEmitter(ALightEmitter* Emitter);
+
+	// Advances the path of every emitter that needs it, within the frame's trace budget
+	void SolveEmitters();
+
+	// Logs every emitter's staleness and trace cost
+	void DumpStats() const;
+
+	// Scene queries the whole pass may make in a frame, and the most one emitter gets before the next one's turn
+	int32 TraceBudget = 256;
+	int32 TracesPerSlice = 64;
+
+	// Emitters whose path has been out of date this many frames are treated like emitters on screen
+	int32 MaxStaleFrames = 30;
+
+	void RegisterReceiver(ULightReceiverComponent* Receiver);
+	void UnregisterReceiver(ULightReceiverComponent* Receiver);
+
+	// Called by an emitter after its path was recomputed. Sends enter and exit events for every change
+	void UpdateEmitterHits(ALightEmitter* Emitter, const FLaserPath& Path);
+	void ClearEmitterHits(ALightEmitter* Emitter);
+
+protected:
+	// Lower goes first, among emitters equally urgent
+	float GetSchedulePriority(const ALightEmitter* Emitter, const FVector& PlayerLocation) const;
+
+	// On screen or starved, these go before the rest
+	bool IsUrgent(const ALightEmitter* Emitter) const;
+
+	ULightReceiverComponent* FindReceiver(const AActor* Actor) const;
+	void SetEmitterHits(ALightEmitter* Emitter, const TArray<ULightReceiverComponent*, TInlineAllocator<4>>& NewHits);
+
+	TArray<ALightEmitter*> Emitters;
+
+	struct FScheduledEmitter
+	{
+		ALightEmitter* Emitter = nullptr;
+		float Priority = 0.f;
+		bool bUrgent = false;
+		int32 TraceAllowance = 0;
+		int32 TracesUsed = 0;
+	};
+
+	// Reused every frame
+	TArray<FScheduledEmitter> Scheduled;
+
+	TMap<const AActor*, ULightReceiverComponent*> ReceiversByOwner;
+
+	// Receivers each emitter's current path hits
+	TMap<TWeakObjectPtr<ALightEmitter>, TArray<ULightReceiverComponent*, TInlineAllocator<4>>> EmitterHits;
+
+	FLaserTickFunction TickFunction;
+};
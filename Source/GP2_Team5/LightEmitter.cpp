@@ -3,134 +3,204 @@
 
 #include "LightEmitter.h"
 #include "Engine/World.h"
+#include "Kismet/GameplayStatics.h"
+#include "GameFramework/Pawn.h"
+#include "Components/PrimitiveComponent.h"
 
-#include "DrawDebugHelpers.h"
+#include "LaserBeamComponent.h"
+#include "GravitySwapComponent.h"
+#include "GravitySwapSubsystem.h"
+#include "GravitySnapshotSubsystem.h"
+#include "GravityApplicatorSubsystem.h"
+#include "LaserSubsystem.h"
 
 ALightEmitter::ALightEmitter()
 {
 	PrimaryActorTick.bCanEverTick = true;
+
+	Beam = CreateDefaultSubobject<ULaserBeamComponent>(TEXT("Beam"));
 }
 
 // Called when the game starts or when spawned
 void ALightEmitter::BeginPlay()
 {
 	Super::BeginPlay();
+
+	// A flip can change where bodies near the beam end up
+	if (UGravitySwapSubsystem* SwapSubsystem = UGravitySwapSubsystem::Get(this))
+	{
+		FlipsAppliedHandle = SwapSubsystem->OnFlipsApplied.AddUObject(this, &ALightEmitter::MarkPathDirty);
+	}
+
+	// Solved together with every other emitter. Ticking is the fallback
+	if (ULaserSubsystem* Lasers = ULaserSubsystem::Get(this))
+	{
+		Lasers->RegisterEmitter(this);
+		SetActorTickEnabled(false);
+	}
 }
 
-// Called every frame
-void ALightEmitter::Tick(float DeltaTime)
+void ALightEmitter::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	QuantizationLevel = FMath::Max(QuantizationLevel, 0.01f);
-	Super::Tick(DeltaTime);
-	if (bIsCCW)
+	if (UGravitySwapSubsystem* SwapSubsystem = UGravitySwapSubsystem::Get(this))
 	{
-		SendLaserCCW(GetActorLocation(), 0);
+		SwapSubsystem->OnFlipsApplied.Remove(FlipsAppliedHandle);
 	}
-	else
+	FlipsAppliedHandle.Reset();
+
+	if (ULaserSubsystem* Lasers = ULaserSubsystem::Get(this))
 	{
-		SendLaserCW(GetActorLocation(), 0);
+		Lasers->UnregisterEmitter(this);
+		Lasers->ClearEmitterHits(this);
 	}
-}
 
+	Super::EndPlay(EndPlayReason);
+}
 
-bool ALightEmitter::SendLaserCCW(FVector Start, int Bounces)
+// Called every frame
+void ALightEmitter::Tick(float DeltaTime)
 {
-	if (Bounces > MaxBounces) return false;
+	Super::Tick(DeltaTime);
 
-	float DistanceFromCenter = Start.Size();
-	Start.Normalize();
+	if (IsPathDirty())
+	{
+		RebuildPath();
+	}
+}
 
-	auto angle = FMath::Atan2(Start.Y, Start.Z);
+void ALightEmitter::RebuildPath()
+{
+	BeginSolve();
+	Solve();
+	FinishSolve();
+}
 
-	for (float i = angle; i < 1.9F * PI + angle; i += QuantizationLevel)
-	{
-		const float StartY = FMath::Sin(i) * DistanceFromCenter;
-		const float StartZ = FMath::Cos(i) * DistanceFromCenter;
-		const float EndY = FMath::Sin(i + QuantizationLevel) * DistanceFromCenter;
-		const float EndZ = FMath::Cos(i + QuantizationLevel) * DistanceFromCenter;
+void ALightEmitter::BeginSolve()
+{
+	QuantizationLevel = FMath::Max(QuantizationLevel, 0.01f);
+	MinQuantizationLevel = FMath::Clamp(MinQuantizationLevel, 0.001f, QuantizationLevel);
+
+	PathEmitterTransform = GetActorTransform();
+	PathQuantizationLevel = QuantizationLevel;
+	PathMinQuantizationLevel = MinQuantizationLevel;
+	bPathCCW = bIsCCW;
+	bPathDirty = false;
+
+	FLaserSolveParams Params;
+	Params.Start = GetActorLocation();
+	Params.bCCW = bIsCCW;
+	Params.QuantizationLevel = QuantizationLevel;
+	Params.MinQuantizationLevel = MinQuantizationLevel;
+	Params.ArcSpan = ArcSpan;
+	Params.MaxBounces = MaxBounces;
+	Params.Emitter = this;
+	Solver.Begin(Params);
+	SolveTraces = 0;
+}
 
-		const FVector StartPoint = { 0.0F, StartY, StartZ };
-		const FVector EndPoint = { 0.0F, EndY, EndZ };
+int32 ALightEmitter::Solve(int32 TraceAllowance)
+{
+	const int32 NumTraces = Solver.Step(GetWorld(), TraceAllowance);
+	SolveTraces += NumTraces;
+	return NumTraces;
+}
 
-		FHitResult Hit;
-		bool bHitSomething = GetWorld()->LineTraceSingleByChannel(Hit, StartPoint, EndPoint, ECollisionChannel::ECC_Visibility);
-		if (bHitSomething)
-		{
-			DrawDebugLine(GetWorld(), StartPoint, Hit.ImpactPoint, FColor(255, 0, 0), false, 0.1f, 0, 3.f);
-			
-			FVector Incidence = (StartPoint - EndPoint).GetSafeNormal();
+void ALightEmitter::FinishSolve()
+{
+	Path.Segments.Reset();
+	Path.Segments.Append(Solver.Segments);
+	Path.Points.Reset();
+	Path.Points.Append(Solver.Points);
+	PathTraces = SolveTraces;
+	FramesStale = 0;
 
-			FQuat Rot = FQuat::FindBetweenNormals(Incidence, Hit.Normal);
-			FVector OutVector = Rot * Hit.Normal;
+	// Compared as they were when traced, so anything that moved while the solve was spread over frames
+	// makes IsPathDirty true on the next frame
+	WatchedComponents.Reset();
+	WatchedComponents.Append(Solver.Touched);
 
-			return SendLaserStraight(Hit.ImpactPoint, OutVector, Bounces + 1);
+	UpdatePathBounds();
 
-		}
-		DrawDebugLine(GetWorld(), StartPoint, EndPoint, FColor(255, 0, 0), false, 0.1f, 0, 3.f);
+	Beam->SetPath(Path.Points);
+	OnLaserPathUpdated.Broadcast(Path);
+
+	if (ULaserSubsystem* Lasers = ULaserSubsystem::Get(this))
+	{
+		Lasers->UpdateEmitterHits(this, Path);
 	}
-	return false;
 }
 
-bool ALightEmitter::SendLaserCW(FVector Start, int Bounces)
+bool ALightEmitter::IsPathDirty() const
 {
-	if (Bounces > MaxBounces) return false;
-
-	float DistanceFromCenter = Start.Size();
-	Start.Normalize();
+	if (bPathDirty || bIsCCW != bPathCCW || QuantizationLevel != PathQuantizationLevel || MinQuantizationLevel != PathMinQuantizationLevel) { return true; }
+	if (GetActorTransform().Equals(PathEmitterTransform) == false) { return true; }
 
-	float Angle = FMath::Atan2(Start.Y, Start.Z);
-
-	for (float i = Angle; i > Angle - 1.9F * PI; i -= QuantizationLevel)
+	// Anything the path was computed against that moved or changed collision
+	for (const FLaserWatchedComponent& Watched : WatchedComponents)
 	{
-		const float StartY = FMath::Sin(i) * DistanceFromCenter;
-		const float StartZ = FMath::Cos(i) * DistanceFromCenter;
-		const float EndY = FMath::Sin(i - QuantizationLevel) * DistanceFromCenter;
-		const float EndZ = FMath::Cos(i - QuantizationLevel) * DistanceFromCenter;
-
-		const FVector StartPoint = { 0.0F, StartY, StartZ };
-		const FVector EndPoint = { 0.0F, EndY, EndZ };
+		const UPrimitiveComponent* Component = Watched.Component.Get();
+		if (Component == nullptr) { return true; }
+		if (Component->GetCollisionEnabled() != Watched.CollisionEnabled) { return true; }
+		if (Component->GetComponentTransform().Equals(Watched.Transform) == false) { return true; }
+	}
 
-		FHitResult Hit;
-		bool bHitSomething = GetWorld()->LineTraceSingleByChannel(Hit, StartPoint, EndPoint, ECollisionChannel::ECC_Visibility);
-		if (bHitSomething)
+	// Moving bodies that may have entered the swept region, simulated or moved by the kinematic LOD.
+	// Resting bodies cost nothing
+	if (const UGravitySnapshotSubsystem* Bodies = UGravitySnapshotSubsystem::Get(this))
+	{
+		const UGravityApplicatorSubsystem* Applicator = UGravityApplicatorSubsystem::Get(this);
+		for (const UGravitySwapComponent* Body : Bodies->GetBodies())
 		{
-			DrawDebugLine(GetWorld(), StartPoint, Hit.ImpactPoint, FColor(255, 0, 0), false, 0.1f, 0, 3.f);
-			
-			FVector Incidence = (StartPoint - EndPoint).GetSafeNormal();
+			const UPrimitiveComponent* PhysicsComp = Body->GetPhysicsComp();
+			if (PhysicsComp == nullptr) { continue; }
 
-			FQuat Rot = FQuat::FindBetweenNormals(Incidence , Hit.Normal);
-			FVector OutVector = Rot * Hit.Normal;
-
-			return SendLaserStraight(Hit.ImpactPoint, OutVector, Bounces + 1);
+			const bool bSimulating = PhysicsComp->IsSimulatingPhysics() && PhysicsComp->RigidBodyIsAwake();
+			const bool bKinematic = Applicator != nullptr && Applicator->GetLODVelocity(Body).IsNearlyZero() == false;
+			if (bSimulating == false && bKinematic == false) { continue; }
+			if (PathIntersects(PhysicsComp->Bounds.GetBox())) { return true; }
 		}
-		DrawDebugLine(GetWorld(), StartPoint, EndPoint, FColor(255, 0, 0), false, 0.1f, 0, 3.f);
 	}
+
+	const APawn* Player = UGameplayStatics::GetPlayerPawn(this, 0);
+	if (Player != nullptr && Player->GetVelocity().IsNearlyZero() == false)
+	{
+		if (PathIntersects(Player->GetComponentsBoundingBox())) { return true; }
+	}
+
 	return false;
 }
 
-bool ALightEmitter::SendLaserStraight(FVector Start, FVector Direction, int Bounces)
+void ALightEmitter::UpdatePathBounds()
 {
-	if (Bounces > MaxBounces) return false;
+	PathBounds.Init();
+	PathPieceBounds.Reset();
 
-	FVector End = Start + 1000.F * Direction;
-
-	FHitResult Hit;
-	bool bHitSomething = GetWorld()->LineTraceSingleByChannel(Hit, Start, End, ECollisionChannel::ECC_Visibility);
-	if (bHitSomething)
+	// Pieces share their end points so no stretch of the path is left out
+	const int32 Stride = FMath::Max(PointsPerPathBounds - 1, 1);
+	const int32 NumPoints = Path.Points.Num();
+	for (int32 First = 0; First < NumPoints; First += Stride)
 	{
-		DrawDebugLine(GetWorld(), Start, Hit.ImpactPoint, FColor(255, 0, 0), false, 0.1f, 0, 3.f);
-		FVector HitDirection = FVector::CrossProduct(Hit.ImpactPoint, Hit.Normal);
-
-		UE_LOG(LogTemp, Warning, TEXT("Send up hit  X =  %f"), HitDirection.X);
-		if (HitDirection.X > 0.0F)
+		FBox Piece(ForceInit);
+		const int32 Last = FMath::Min(First + Stride, NumPoints - 1);
+		for (int32 i = First; i <= Last; i++)
 		{
-			return SendLaserCW(Hit.ImpactPoint, Bounces + 1);
-		}
-		else
-		{
-			return SendLaserCCW(Hit.ImpactPoint, Bounces + 1);
+			Piece += Path.Points[i];
 		}
+		Piece = Piece.ExpandBy(1.f);
+		PathPieceBounds.Add(Piece);
+		PathBounds += Piece;
+
+		if (Last == NumPoints - 1) { break; }
+	}
+}
+
+bool ALightEmitter::PathIntersects(const FBox& Box) const
+{
+	if (PathBounds.Intersect(Box) == false) { return false; }
+
+	for (const FBox& Piece : PathPieceBounds)
+	{
+		if (Piece.Intersect(Box)) { return true; }
 	}
-	DrawDebugLine(GetWorld(), Start, End, FColor(255, 0, 0), false, 0.1f, 0, 3.f);
 	return false;
 }
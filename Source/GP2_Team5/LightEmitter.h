@@ -4,30 +4,105 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "LaserPathSolver.h"
 #include "LightEmitter.generated.h"
 
 UCLASS()
 class GP2_TEAM5_API ALightEmitter : public AActor
 {
 	GENERATED_BODY()
-	
-public:	
+
+public:
 	ALightEmitter();
 
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void Tick(float DeltaTime) override;
 
-	bool SendLaserCCW(FVector Start, int Bounces);
-	bool SendLaserCW(FVector Start, int Bounces);
+	UFUNCTION(BlueprintPure, Category = "Laser")
+	const FLaserPath& GetLaserPath() const { return Path; }
+
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnLaserPathUpdated, const FLaserPath&, NewPath);
+
+	/* Broadcast whenever the path is recomputed */
+	UPROPERTY(BlueprintAssignable, Category = "Laser")
+	FOnLaserPathUpdated OnLaserPathUpdated;
+
+	// Forces the path to be recomputed on the next tick
+	UFUNCTION(BlueprintCallable, Category = "Laser")
+	void MarkPathDirty() { bPathDirty = true; }
+
+	bool IsPathDirty() const;
 
-	bool SendLaserStraight(FVector Start, FVector Direction, int Bounces);
+	// A rebuild in three steps so ULaserSubsystem can run the middle one on worker threads and spread it over frames.
+	// BeginSolve and FinishSolve are game thread only. Solve only writes this emitter's solver buffers,
+	// makes about TraceAllowance scene queries and returns how many it made. Call it until IsSolving is false
+	void BeginSolve();
+	int32 Solve(int32 TraceAllowance = MAX_int32);
+	void FinishSolve();
+
+	bool IsSolving() const { return Solver.IsDone() == false; }
+
+	/* Frames the published path has been out of date for, 0 when it is current */
+	UFUNCTION(BlueprintPure, Category = "Laser")
+	int32 GetFramesStale() const { return FramesStale; }
+
+	/* Scene queries the current path took to solve */
+	UFUNCTION(BlueprintPure, Category = "Laser")
+	int32 GetPathTraces() const { return PathTraces; }
 
 protected:
+	void RebuildPath();
+	void UpdatePathBounds();
+
+	// Whether Box overlaps the bounds of some stretch of the cached path
+	bool PathIntersects(const FBox& Box) const;
+
+	/* Draws the cached path. Only updated when the path is rebuilt */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Laser")
+	class ULaserBeamComponent* Beam;
+
 	UPROPERTY(Editanywhere, BlueprintReadWrite)
 	float QuantizationLevel = 0.1F;
 
+	/* Smallest arc step (radians), used next to geometry. Arcs step up to QuantizationLevel in free space */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MinQuantizationLevel = 0.02F;
+
 	UPROPERTY(Editanywhere)
 	bool bIsCCW = false;
 
-	int32 MaxBounces = 12;
+	int32 MaxBounces = MaxLaserBounces;
+
+	// How far around the circle an arc is traced before it gives up
+	float ArcSpan = 1.9F * PI;
+
+	// Cached path, recomputed only when something that can change it does
+	UPROPERTY(BlueprintReadOnly, Category = "Laser")
+	FLaserPath Path;
+
+	// Kept so solving doesn't allocate once the buffers have grown. May hold a partial path between frames
+	FLaserPathSolver Solver;
+	int32 SolveTraces = 0;
+	int32 PathTraces = 0;
+	int32 FramesStale = 0;
+
+	TArray<FLaserWatchedComponent> WatchedComponents;
+
+	// Bounds of the whole path, and of every PointsPerPathBounds consecutive points of it.
+	// An arc's overall bounds can cover most of the planet, the pieces follow the beam
+	FBox PathBounds { ForceInit };
+	TArray<FBox> PathPieceBounds;
+	int32 PointsPerPathBounds = 8;
+
+	// Inputs the cached path was computed with
+	FTransform PathEmitterTransform;
+	float PathQuantizationLevel = 0.f;
+	float PathMinQuantizationLevel = 0.f;
+	bool bPathCCW = false;
+	bool bPathDirty = true;
+
+	FDelegateHandle FlipsAppliedHandle;
+
+	friend class ULaserSubsystem;
 };
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LightReceiverComponent.h"
+#include "LaserSubsystem.h"
+
+ULightReceiverComponent::ULightReceiverComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void ULightReceiverComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (ULaserSubsystem* Lasers = ULaserSubsystem::Get(this))
+	{
+		Lasers->RegisterReceiver(this);
+	}
+}
+
+void ULightReceiverComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (ULaserSubsystem* Lasers = ULaserSubsystem::Get(this))
+	{
+		Lasers->UnregisterReceiver(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ULightReceiverComponent::AddEmitter(ALightEmitter* Emitter)
+{
+	if (NumEmitters++ == 0)
+	{
+		OnLightEnter.Broadcast(Emitter);
+	}
+}
+
+void ULightReceiverComponent::RemoveEmitter(ALightEmitter* Emitter)
+{
+	if (NumEmitters == 0) { return; }
+
+	if (--NumEmitters == 0)
+	{
+		OnLightExit.Broadcast(Emitter);
+	}
+}
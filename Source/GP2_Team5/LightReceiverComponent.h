@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "LightReceiverComponent.generated.h"
+
+//--- forward declarations ---
+class ALightEmitter;
+
+/**
+ * Makes its owner a light sensor. Any laser path that ends on one of the owner's components lights it.
+ * Events fire once per transition, so doors and switches don't need to poll the beam.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class GP2_TEAM5_API ULightReceiverComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	ULightReceiverComponent();
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnLightDelegate, ALightEmitter*, Emitter);
+
+	/* The first emitter started hitting this receiver */
+	UPROPERTY(BlueprintAssignable, Category = "Laser")
+	FOnLightDelegate OnLightEnter;
+
+	/* The last emitter stopped hitting this receiver */
+	UPROPERTY(BlueprintAssignable, Category = "Laser")
+	FOnLightDelegate OnLightExit;
+
+	UFUNCTION(BlueprintPure, Category = "Laser")
+	bool IsLit() const { return NumEmitters > 0; }
+
+	// Called by ULaserSubsystem
+	void AddEmitter(ALightEmitter* Emitter);
+	void RemoveEmitter(ALightEmitter* Emitter);
+
+protected:
+	int32 NumEmitters = 0;
+};
@@ -3,3 +3,11 @@
 
 #include "SaveGameScript.h"
 
+bool USaveGameScript::Migrate()
+{
+	if (Version > LatestVersion) { return false; }
+
+	// No layout changes yet. Upgrades go here, oldest first
+	Version = LatestVersion;
+	return true;
+}
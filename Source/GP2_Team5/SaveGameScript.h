@@ -6,12 +6,56 @@
 #include "GameFramework/SaveGame.h"
 #include "SaveGameScript.generated.h"
 
+// Coins of one collectible field that were collected
+USTRUCT()
+struct FSavedFieldCoins
+{
+	GENERATED_BODY()
+
+	/* Instance indices, stable since collected coins are scaled to zero rather than removed */
+	UPROPERTY()
+	TArray<int32> Collected;
+};
+
 /**
- * 
+ * Player progress written by USaveGameSubsystem.
+ * Level state is keyed by the path name of what was placed in the level, which includes the level itself.
+ * Fields are serialized as tagged properties, so adding one doesn't break older saves.
+ * Changes that need more than a default value bump LatestVersion and upgrade the old data in Migrate.
  */
 UCLASS()
 class GP2_TEAM5_API USaveGameScript : public USaveGame
 {
 	GENERATED_BODY()
-	
+
+public:
+	static constexpr int32 LatestVersion = 1;
+
+	// Upgrades data loaded from an older version. Returns false when the save can't be used by this build
+	bool Migrate();
+
+	UPROPERTY()
+	int32 Version = LatestVersion;
+
+	UPROPERTY()
+	FName LevelName;
+
+	UPROPERTY()
+	FName CheckpointId;
+
+	/* The player's SaveGame properties (collectibles, relics), serialized with ArIsSaveGame */
+	UPROPERTY()
+	TArray<uint8> PlayerData;
+
+	/* Flip of every placed swappable body, by path name. Levels saved earlier keep their entries */
+	UPROPERTY()
+	TMap<FString, bool> FlipStates;
+
+	/* Placed pickups that were collected, by path name */
+	UPROPERTY()
+	TSet<FString> CollectedPickups;
+
+	/* Collected coins of every placed collectible field, by path name */
+	UPROPERTY()
+	TMap<FString, FSavedFieldCoins> CollectedCoins;
 };
@@ -0,0 +1,343 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SaveGameSubsystem.h"
+#include "Engine/World.h"
+#include "Engine/GameInstance.h"
+#include "Kismet/GameplayStatics.h"
+#include "Async/Async.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+#include "SaveGameScript.h"
+#include "GravityCharacter.h"
+#include "GravitySwapComponent.h"
+#include "GravitySnapshotSubsystem.h"
+#include "GravityMovementComponent.h"
+#include "CheckpointSubsystem.h"
+#include "Checkpoint.h"
+#include "Collectible.h"
+#include "CollectibleField.h"
+#include "EngineUtils.h"
+
+void USaveGameSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Loaded once while the game boots, before there is anything to hitch
+	if (UGameplayStatics::DoesSaveGameExist(SlotName, UserIndex))
+	{
+		Progress = Cast<USaveGameScript>(UGameplayStatics::LoadGameFromSlot(SlotName, UserIndex));
+		if (Progress != nullptr && Progress->Migrate() == false)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Save game version %d is newer than this build supports, starting without progress"), Progress->Version);
+			Progress = nullptr;
+		}
+	}
+
+	bHasProgress = Progress != nullptr;
+	if (Progress == nullptr)
+	{
+		Progress = Cast<USaveGameScript>(UGameplayStatics::CreateSaveGameObject(USaveGameScript::StaticClass()));
+	}
+}
+
+void USaveGameSubsystem::Deinitialize()
+{
+	// The last autosave must reach the disk
+	if (WriteFuture.IsValid())
+	{
+		WriteFuture.Wait();
+	}
+	if (PendingData.Num() > 0)
+	{
+		UGameplayStatics::SaveDataToSlot(PendingData, SlotName, UserIndex);
+		PendingData.Reset();
+	}
+
+	Super::Deinitialize();
+}
+
+USaveGameSubsystem* USaveGameSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject != nullptr ? WorldContextObject->GetWorld() : nullptr;
+	if (World == nullptr || World->IsGameWorld() == false || World->GetGameInstance() == nullptr) { return nullptr; }
+
+	return World->GetGameInstance()->GetSubsystem<USaveGameSubsystem>();
+}
+
+FName USaveGameSubsystem::GetCheckpointId() const
+{
+	return Progress != nullptr ? Progress->CheckpointId : NAME_None;
+}
+
+void USaveGameSubsystem::SaveProgress(FName CheckpointId)
+{
+	UWorld* World = GetGameInstance()->GetWorld();
+	if (World == nullptr || Progress == nullptr) { return; }
+
+	Progress->Version = USaveGameScript::LatestVersion;
+	Progress->LevelName = FName(*UGameplayStatics::GetCurrentLevelName(World));
+	Progress->CheckpointId = CheckpointId;
+	GatherPlayer(Cast<AGravityCharacter>(UGameplayStatics::GetPlayerPawn(World, 0)));
+	GatherFlips(World);
+	GatherCollected(World);
+	bHasProgress = true;
+
+	// A few hundred bytes, serialized here so the worker thread never touches UObjects
+	TArray<uint8> Data;
+	if (UGameplayStatics::SaveGameToMemory(Progress, Data) == false) { return; }
+
+	// Nothing changed since the file was last written, or since the save already waiting
+	const TArray<uint8>& Latest = PendingData.Num() > 0 ? PendingData : (bWriting ? WritingData : WrittenData);
+	if (Data == Latest) { return; }
+
+	PendingData = MoveTemp(Data);
+	if (bWriting == false)
+	{
+		StartWrite();
+	}
+}
+
+void USaveGameSubsystem::ApplyProgress()
+{
+	UWorld* World = GetGameInstance()->GetWorld();
+	if (World == nullptr || bHasProgress == false) { return; }
+
+	AGravityCharacter* Player = Cast<AGravityCharacter>(UGameplayStatics::GetPlayerPawn(World, 0));
+	ApplyPlayer(Player);
+	ApplyFlips(World);
+	ApplyCollected(World);
+
+	// Checkpoint ids are only unique within a level
+	if (Progress->LevelName == FName(*UGameplayStatics::GetCurrentLevelName(World)))
+	{
+		ApplyCheckpoint(World, Player);
+	}
+}
+
+void USaveGameSubsystem::DeleteProgress()
+{
+	// A write still in flight would bring the file back
+	if (WriteFuture.IsValid())
+	{
+		WriteFuture.Wait();
+	}
+	PendingData.Reset();
+	WritingData.Reset();
+	WrittenData.Reset();
+	bWriting = false;
+
+	// Its completion is still queued on the game thread
+	WriteGeneration++;
+
+	UGameplayStatics::DeleteGameInSlot(SlotName, UserIndex);
+	Progress = Cast<USaveGameScript>(UGameplayStatics::CreateSaveGameObject(USaveGameScript::StaticClass()));
+	bHasProgress = false;
+}
+
+void USaveGameSubsystem::GatherPlayer(const AGravityCharacter* Player)
+{
+	if (Player == nullptr) { return; }
+
+	// Only properties tagged SaveGame are written
+	Progress->PlayerData.Reset();
+	FMemoryWriter Writer(Progress->PlayerData, true);
+	FObjectAndNameAsStringProxyArchive Archive(Writer, true);
+	Archive.ArIsSaveGame = true;
+	const_cast<AGravityCharacter*>(Player)->Serialize(Archive);
+}
+
+void USaveGameSubsystem::ApplyPlayer(AGravityCharacter* Player) const
+{
+	if (Player == nullptr || Progress->PlayerData.Num() == 0) { return; }
+
+	FMemoryReader Reader(Progress->PlayerData, true);
+	FObjectAndNameAsStringProxyArchive Archive(Reader, true);
+	Archive.ArIsSaveGame = true;
+	Player->Serialize(Archive);
+
+	// Lets the HUD catch up with the restored counts
+	for (const TPair<ECollectibleType, int32>& Collectible : Player->Collectibles)
+	{
+		Player->OnCollectibleAdded(Collectible.Key, Collectible.Value);
+	}
+}
+
+void USaveGameSubsystem::GatherFlips(UWorld* World)
+{
+	const UGravitySnapshotSubsystem* Bodies = UGravitySnapshotSubsystem::Get(World);
+	if (Bodies == nullptr) { return; }
+
+	// Only this level's entries are touched, the ones of other levels stay as loaded
+	for (const UGravitySwapComponent* Body : Bodies->GetBodies())
+	{
+		const FString Key = GetSaveKey(Body);
+		if (Key.IsEmpty() == false)
+		{
+			Progress->FlipStates.Add(Key, Body->GetFlipGravity());
+		}
+	}
+}
+
+void USaveGameSubsystem::ApplyFlips(UWorld* World) const
+{
+	const UGravitySnapshotSubsystem* Bodies = UGravitySnapshotSubsystem::Get(World);
+	if (Bodies == nullptr || Progress->FlipStates.Num() == 0) { return; }
+
+	TArray<UGravitySwapComponent*, TInlineAllocator<16>> Changed;
+	for (UGravitySwapComponent* Body : Bodies->GetBodies())
+	{
+		const bool* bSavedFlip = Progress->FlipStates.Find(GetSaveKey(Body));
+		if (bSavedFlip != nullptr && *bSavedFlip != Body->GetFlipGravity())
+		{
+			Body->ApplyFlipGravity(*bSavedFlip);
+			Changed.Add(Body);
+		}
+	}
+
+	// Listeners see the fully restored level, like after a swap flush
+	for (UGravitySwapComponent* Body : Changed)
+	{
+		Body->NotifyFlipGravity();
+	}
+}
+
+void USaveGameSubsystem::GatherCollected(UWorld* World)
+{
+	const UCheckpointSubsystem* Checkpoints = UCheckpointSubsystem::Get(World);
+	if (Checkpoints == nullptr) { return; }
+
+	// Like the flips, only this level's entries are touched
+	for (const ACollectible* Collectible : Checkpoints->GetCollectibles())
+	{
+		const FString Key = GetSaveKey(Collectible);
+		if (Key.IsEmpty()) { continue; }
+
+		if (Collectible->IsCollected())
+		{
+			Progress->CollectedPickups.Add(Key);
+		}
+		else
+		{
+			Progress->CollectedPickups.Remove(Key);
+		}
+	}
+
+	for (const ACollectibleField* Field : Checkpoints->GetFields())
+	{
+		const FString Key = GetSaveKey(Field);
+		if (Key.IsEmpty()) { continue; }
+
+		if (Field->GetNumCollected() == 0)
+		{
+			Progress->CollectedCoins.Remove(Key);
+			continue;
+		}
+		Field->GetCollectedCoins(Progress->CollectedCoins.FindOrAdd(Key).Collected);
+	}
+}
+
+void USaveGameSubsystem::ApplyCollected(UWorld* World) const
+{
+	const UCheckpointSubsystem* Checkpoints = UCheckpointSubsystem::Get(World);
+	if (Checkpoints == nullptr) { return; }
+
+	if (Progress->CollectedPickups.Num() > 0)
+	{
+		for (ACollectible* Collectible : Checkpoints->GetCollectibles())
+		{
+			if (Progress->CollectedPickups.Contains(GetSaveKey(Collectible)))
+			{
+				Collectible->SetCollected(true);
+			}
+		}
+	}
+
+	if (Progress->CollectedCoins.Num() > 0)
+	{
+		for (ACollectibleField* Field : Checkpoints->GetFields())
+		{
+			if (const FSavedFieldCoins* Coins = Progress->CollectedCoins.Find(GetSaveKey(Field)))
+			{
+				Field->SetCollectedCoins(Coins->Collected);
+			}
+		}
+	}
+}
+
+void USaveGameSubsystem::ApplyCheckpoint(UWorld* World, AGravityCharacter* Player) const
+{
+	if (Player == nullptr || Progress->CheckpointId == NAME_None) { return; }
+
+	for (TActorIterator<ACheckpoint> It(World); It; ++It)
+	{
+		if (It->GetCheckpointId() != Progress->CheckpointId) { continue; }
+
+		Player->SetActorLocation(It->GetRespawnLocation(), false, nullptr, ETeleportType::ResetPhysics);
+		if (UGravityMovementComponent* Movement = Player->CachedGravityMovementyCmp)
+		{
+			Movement->StopMovementImmediately();
+		}
+
+		// Recorded as it was restored, so dying brings the player back here
+		if (UCheckpointSubsystem* Checkpoints = UCheckpointSubsystem::Get(World))
+		{
+			Checkpoints->EnterCheckpoint(*It);
+		}
+		return;
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("Saved checkpoint %s isn't in %s"), *Progress->CheckpointId.ToString(), *Progress->LevelName.ToString());
+}
+
+FString USaveGameSubsystem::GetSaveKey(const UObject* Object)
+{
+	const UActorComponent* Component = Cast<UActorComponent>(Object);
+	const AActor* Owner = Component != nullptr ? Component->GetOwner() : Cast<AActor>(Object);
+	if (Owner == nullptr || Owner->HasAnyFlags(RF_WasLoaded) == false) { return FString(); }
+
+	// The same in the editor and in a packaged game
+	return UWorld::RemovePIEPrefix(Object->GetPathName());
+}
+
+void USaveGameSubsystem::StartWrite()
+{
+	WritingData = MoveTemp(PendingData);
+	PendingData.Reset();
+	bWriting = true;
+	const int32 Generation = ++WriteGeneration;
+
+	TWeakObjectPtr<USaveGameSubsystem> WeakThis(this);
+	WriteFuture = Async(EAsyncExecution::ThreadPool, [WeakThis, Generation, Data = WritingData, Slot = SlotName, User = UserIndex]()
+	{
+		const bool bSuccess = UGameplayStatics::SaveDataToSlot(Data, Slot, User);
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Generation, bSuccess]()
+		{
+			if (USaveGameSubsystem* Subsystem = WeakThis.Get())
+			{
+				Subsystem->OnWriteFinished(Generation, bSuccess);
+			}
+		});
+		return bSuccess;
+	});
+}
+
+void USaveGameSubsystem::OnWriteFinished(int32 Generation, bool bSuccess)
+{
+	if (bWriting == false || Generation != WriteGeneration) { return; }
+
+	bWriting = false;
+	if (bSuccess)
+	{
+		WrittenData = MoveTemp(WritingData);
+	}
+	WritingData.Reset();
+
+	OnProgressSaved.Broadcast(bSuccess);
+
+	if (PendingData.Num() > 0)
+	{
+		StartWrite();
+	}
+}
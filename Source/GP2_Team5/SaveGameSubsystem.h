@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Async/Future.h"
+#include "SaveGameSubsystem.generated.h"
+
+//--- forward declarations ---
+class USaveGameScript;
+class AGravityCharacter;
+
+/**
+ * Saves and loads the player's progress: collectibles, relics, the last checkpoint, the flip of every placed
+ * swappable body, and which placed pickups and field coins were collected.
+ * Lives with the game instance so progress carries over between levels.
+ * A save serializes the small USaveGameScript on the game thread and writes the file on a worker thread, so
+ * autosaves don't hitch. Saves that wouldn't change the file are skipped, and a save requested while another one
+ * is being written replaces any save still waiting behind it.
+ */
+UCLASS()
+class GP2_TEAM5_API USaveGameSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	static USaveGameSubsystem* Get(const UObject* WorldContextObject);
+
+	// Gathers progress from the current world and writes it in the background
+	UFUNCTION(BlueprintCallable, Category = "SaveGame")
+	void SaveProgress(FName CheckpointId);
+
+	// Gives the player its saved collectibles and relics, and sets the saved flips and collected pickups in the current level.
+	// In the level the save was made in, the player also starts at the saved checkpoint. Called by the game mode at level start
+	UFUNCTION(BlueprintCallable, Category = "SaveGame")
+	void ApplyProgress();
+
+	// Forgets all progress and deletes the save file
+	UFUNCTION(BlueprintCallable, Category = "SaveGame")
+	void DeleteProgress();
+
+	UFUNCTION(BlueprintPure, Category = "SaveGame")
+	bool HasProgress() const { return bHasProgress; }
+
+	UFUNCTION(BlueprintPure, Category = "SaveGame")
+	FName GetCheckpointId() const;
+
+	UFUNCTION(BlueprintPure, Category = "SaveGame")
+	bool IsSaving() const { return bWriting; }
+
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnProgressSaved, bool, bSuccess);
+
+	/* Broadcast on the game thread when a write finished */
+	UPROPERTY(BlueprintAssignable, Category = "SaveGame")
+	FOnProgressSaved OnProgressSaved;
+
+protected:
+	void GatherPlayer(const AGravityCharacter* Player);
+	void ApplyPlayer(AGravityCharacter* Player) const;
+	void GatherFlips(UWorld* World);
+	void ApplyFlips(UWorld* World) const;
+	void GatherCollected(UWorld* World);
+	void ApplyCollected(UWorld* World) const;
+	void ApplyCheckpoint(UWorld* World, AGravityCharacter* Player) const;
+
+	// Key of a placed actor or of one of its components in USaveGameScript, empty for actors spawned at runtime
+	static FString GetSaveKey(const UObject* Object);
+
+	void StartWrite();
+	void OnWriteFinished(int32 Generation, bool bSuccess);
+
+	UPROPERTY()
+	USaveGameScript* Progress = nullptr;
+
+	FString SlotName = TEXT("Progress");
+	int32 UserIndex = 0;
+	bool bHasProgress = false;
+
+	// Bytes of the last write that succeeded, a save producing the same bytes is skipped
+	TArray<uint8> WrittenData;
+
+	// Being written, and the latest save waiting for that write to finish
+	TArray<uint8> WritingData;
+	TArray<uint8> PendingData;
+	TFuture<bool> WriteFuture;
+	bool bWriting = false;
+
+	// Counts started writes. A completion from an older write, e.g. one abandoned by DeleteProgress, is ignored
+	int32 WriteGeneration = 0;
+};
@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SwapPartnerSolver.h"
+#include "GravityCharacter.h"
+#include "GravitySwapComponent.h"
+#include "ClickInteractComponent.h"
+
+void FSwapPartnerSolver::Solve(AGravityCharacter* Player, UClickInteractComponent* NewFocus, const TArray<UClickInteractComponent*>& Candidates)
+{
+	Reset();
+	if (Player == nullptr || NewFocus == nullptr) { return; }
+
+	Focus = NewFocus;
+
+	UGravitySwapComponent* FocusSwapComp = GetSwapComponent(Focus);
+	if (FocusSwapComp == nullptr) { return; }
+
+	// Gather candidate state into flat arrays
+	CandidateComps.Reserve(Candidates.Num());
+	CandidateTypes.Reserve(Candidates.Num());
+	CandidateFlips.Reserve(Candidates.Num());
+	CandidateLocations.Reserve(Candidates.Num());
+	for (UClickInteractComponent* Comp : Candidates)
+	{
+		if (Comp == nullptr || Comp == Focus) { continue; }
+
+		UGravitySwapComponent* SwapComp = GetSwapComponent(Comp);
+		if (SwapComp == nullptr) { continue; }
+
+		CandidateComps.Add(Comp);
+		CandidateTypes.Add(Player->GetClickFocusType(Comp));
+		CandidateFlips.Add(SwapComp->GetFlipGravity());
+		CandidateLocations.Add(Comp->GetOwner()->GetActorLocation());
+	}
+
+	// Relic, range and flip rules in one pass
+	const bool bFocusIsPlayer = Player->GetClickFocusType(Focus) == EFocusType::Player;
+	const bool bFocusFlip = FocusSwapComp->GetFlipGravity();
+	const bool bHasRelic1 = Player->HasRelic1();
+	const bool bHasRelic2 = Player->HasRelic2();
+	const FVector PlayerLocation = Player->GetActorLocation();
+	const float RangeSquared = FMath::Square(Player->GetClickInteractRange());
+
+	Survivors.Reserve(CandidateComps.Num());
+	for (int32 i = 0; i < CandidateComps.Num(); i++)
+	{
+		// Relic1 swaps between player + obj, Relic2 swaps between obj + obj
+		const bool bInvolvesPlayer = bFocusIsPlayer || CandidateTypes[i] == EFocusType::Player;
+		const bool bHasPower = bInvolvesPlayer ? bHasRelic1 : bHasRelic2;
+		const bool bWithinRange = FVector::DistSquared(PlayerLocation, CandidateLocations[i]) < RangeSquared;
+		const bool bOppositeGravity = CandidateFlips[i] != bFocusFlip;
+
+		if (bHasPower && bWithinRange && bOppositeGravity)
+		{
+			Survivors.Add(i);
+		}
+	}
+
+	if (Survivors.Num() == 0) { return; }
+
+	// Line of sight only for the survivors. The focus is shared by every pair so it is checked once
+	if (Player->IsComponentInLineOfSight(Focus) == false) { return; }
+
+	Partners.Reserve(Survivors.Num());
+	for (int32 Index : Survivors)
+	{
+		if (Player->IsComponentInLineOfSight(CandidateComps[Index]))
+		{
+			Partners.Add(CandidateComps[Index]);
+		}
+	}
+}
+
+void FSwapPartnerSolver::Reset()
+{
+	CandidateComps.Reset();
+	CandidateTypes.Reset();
+	CandidateFlips.Reset();
+	CandidateLocations.Reset();
+	Survivors.Reset();
+	Partners.Reset();
+	Focus = nullptr;
+}
+
+UGravitySwapComponent* FSwapPartnerSolver::GetSwapComponent(const UActorComponent* Comp)
+{
+	if (Comp == nullptr || Comp->GetOwner() == nullptr) { return nullptr; }
+
+	return Cast<UGravitySwapComponent>(GetComponentByInterface<UGravitySwappable>(Comp->GetOwner()));
+}
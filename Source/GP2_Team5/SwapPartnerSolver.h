@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Enums.h"
+
+//--- forward declarations ---
+class AGravityCharacter;
+class UClickInteractComponent;
+class UGravitySwapComponent;
+
+/**
+ * Finds every component the player's current click focus can swap gravity with.
+ * Candidate state is gathered into flat arrays so the relic, range and flip rules run in one pass,
+ * and only the survivors are sent to the line of sight checks.
+ */
+struct GP2_TEAM5_API FSwapPartnerSolver
+{
+public:
+	// Rebuilds the partner set of NewFocus from the given candidates
+	void Solve(AGravityCharacter* Player, UClickInteractComponent* NewFocus, const TArray<UClickInteractComponent*>& Candidates);
+	void Reset();
+
+	bool IsPartner(const UClickInteractComponent* Comp) const { return Comp != nullptr && Partners.Contains(Comp); }
+	const TArray<UClickInteractComponent*>& GetPartners() const { return Partners; }
+	UClickInteractComponent* GetFocus() const { return Focus; }
+
+	static UGravitySwapComponent* GetSwapComponent(const UActorComponent* Comp);
+
+private:
+	// One entry per candidate, same index in every array
+	TArray<UClickInteractComponent*> CandidateComps;
+	TArray<EFocusType> CandidateTypes;
+	TArray<bool> CandidateFlips;
+	TArray<FVector> CandidateLocations;
+
+	// Indices into the candidate arrays that passed the rules pass
+	TArray<int32> Survivors;
+
+	TArray<UClickInteractComponent*> Partners;
+	UClickInteractComponent* Focus = nullptr;
+};
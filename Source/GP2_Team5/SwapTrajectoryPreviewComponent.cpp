@@ -0,0 +1,208 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SwapTrajectoryPreviewComponent.h"
+#include "Async/Async.h"
+#include "Engine/World.h"
+#include "Components/PrimitiveComponent.h"
+#include "GravitySwapComponent.h"
+
+// UserData layout of a sweep: generation | path index | segment index
+static uint32 PackSweepUserData(uint8 Generation, int32 PathIndex, int32 Segment)
+{
+	return (uint32(Generation) << 24) | (uint32(PathIndex & 0xFF) << 16) | uint32(Segment & 0xFFFF);
+}
+
+USwapTrajectoryPreviewComponent::USwapTrajectoryPreviewComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+
+	SweepDelegate.BindUObject(this, &USwapTrajectoryPreviewComponent::OnSweepCompleted);
+}
+
+void USwapTrajectoryPreviewComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	ClearPreview();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void USwapTrajectoryPreviewComponent::StartPreview(UGravitySwapComponent* First, UGravitySwapComponent* Second)
+{
+	if (IsPreviewing(First, Second)) { return; }
+
+	ClearPreview();
+	Generation++;
+
+	for (UGravitySwapComponent* Body : { First, Second })
+	{
+		UPrimitiveComponent* PhysicsComp = Body != nullptr ? Body->GetPhysicsComp() : nullptr;
+		if (PhysicsComp == nullptr || PhysicsComp->IsSimulatingPhysics() == false) { continue; }
+
+		FSwapTrajectoryPath& Path = Paths.AddDefaulted_GetRef();
+		Path.Body = Body;
+		Path.SweepRadius = PhysicsComp->Bounds.BoxExtent.GetMin();
+		StartPath(Paths.Num() - 1);
+	}
+
+	SetComponentTickEnabled(Paths.Num() > 0);
+}
+
+void USwapTrajectoryPreviewComponent::ClearPreview()
+{
+	if (Paths.Num() == 0) { return; }
+
+	// Running simulations finish on their own, their results are simply dropped
+	Paths.Reset();
+	Generation++;
+	SetComponentTickEnabled(false);
+	OnTrajectoryPreviewCleared.Broadcast();
+}
+
+bool USwapTrajectoryPreviewComponent::IsPreviewing(const UGravitySwapComponent* First, const UGravitySwapComponent* Second) const
+{
+	bool bHasFirst = First == nullptr;
+	bool bHasSecond = Second == nullptr;
+	for (const FSwapTrajectoryPath& Path : Paths)
+	{
+		bHasFirst |= Path.Body.Get() == First;
+		bHasSecond |= Path.Body.Get() == Second;
+	}
+	return Paths.Num() > 0 && bHasFirst && bHasSecond;
+}
+
+void USwapTrajectoryPreviewComponent::StartPath(int32 PathIndex)
+{
+	FSwapTrajectoryPath& Path = Paths[PathIndex];
+	UGravitySwapComponent* Body = Path.Body.Get();
+	UPrimitiveComponent* PhysicsComp = Body->GetPhysicsComp();
+
+	// The path after the swap, so with the flipped gravity
+	FSwapTrajectoryInput Input;
+	Input.Location = PhysicsComp->GetComponentLocation();
+	Input.Velocity = PhysicsComp->GetPhysicsLinearVelocity();
+	Input.GravityPoint = Body->GetGravityPoint();
+	Input.Acceleration = Body->GetGravityAcceleration() * (Body->GetFlipGravity() ? 1.f : -1.f);
+	Input.NumSteps = NumSteps;
+	Input.StepTime = StepTime;
+	Input.StepsPerPoint = StepsPerPoint;
+
+	Path.Simulation = Async(EAsyncExecution::ThreadPool, [Input]() { return SimulatePath(Input); });
+	Path.bSimulating = true;
+}
+
+void USwapTrajectoryPreviewComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	bool bWaiting = false;
+	for (int32 i = 0; i < Paths.Num(); i++)
+	{
+		FSwapTrajectoryPath& Path = Paths[i];
+		if (Path.bSimulating == false) { continue; }
+
+		if (Path.Simulation.IsReady() == false)
+		{
+			bWaiting = true;
+			continue;
+		}
+
+		Path.Points = Path.Simulation.Get();
+		Path.bSimulating = false;
+		IssueSweeps(i);
+	}
+
+	// Sweep results arrive through OnSweepCompleted, no need to keep ticking for them
+	if (bWaiting == false)
+	{
+		SetComponentTickEnabled(false);
+	}
+}
+
+TArray<FVector> USwapTrajectoryPreviewComponent::SimulatePath(const FSwapTrajectoryInput& Input)
+{
+	TArray<FVector> Points;
+	Points.Reserve(Input.NumSteps / FMath::Max(Input.StepsPerPoint, 1) + 2);
+	Points.Add(Input.Location);
+
+	// Semi-implicit Euler under radial gravity
+	FVector Location = Input.Location;
+	FVector Velocity = Input.Velocity;
+	for (int32 Step = 1; Step <= Input.NumSteps; Step++)
+	{
+		const FVector GravityDirection = (Input.GravityPoint - Location).GetSafeNormal();
+		Velocity += GravityDirection * Input.Acceleration * Input.StepTime;
+		Location += Velocity * Input.StepTime;
+
+		if (Step % Input.StepsPerPoint == 0 || Step == Input.NumSteps)
+		{
+			Points.Add(Location);
+		}
+	}
+	return Points;
+}
+
+void USwapTrajectoryPreviewComponent::IssueSweeps(int32 PathIndex)
+{
+	FSwapTrajectoryPath& Path = Paths[PathIndex];
+	if (Path.Points.Num() < 2)
+	{
+		PublishPath(PathIndex);
+		return;
+	}
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SwapTrajectoryPreview), false);
+	QueryParams.AddIgnoredActor(GetOwner());
+	if (UGravitySwapComponent* Body = Path.Body.Get())
+	{
+		QueryParams.AddIgnoredActor(Body->GetOwner());
+	}
+
+	const FCollisionShape Shape = FCollisionShape::MakeSphere(Path.SweepRadius);
+	Path.PendingSweeps = Path.Points.Num() - 1;
+	Path.FirstBlockedSegment = INDEX_NONE;
+	for (int32 Segment = 0; Segment < Path.Points.Num() - 1; Segment++)
+	{
+		GetWorld()->AsyncSweepByChannel(EAsyncTraceType::Single, Path.Points[Segment], Path.Points[Segment + 1], SweepChannel, Shape,
+			QueryParams, FCollisionResponseParams::DefaultResponseParam, &SweepDelegate, PackSweepUserData(Generation, PathIndex, Segment));
+	}
+}
+
+void USwapTrajectoryPreviewComponent::OnSweepCompleted(const FTraceHandle& Handle, FTraceDatum& Datum)
+{
+	if ((Datum.UserData >> 24) != Generation) { return; }
+
+	const int32 PathIndex = (Datum.UserData >> 16) & 0xFF;
+	const int32 Segment = Datum.UserData & 0xFFFF;
+	if (Paths.IsValidIndex(PathIndex) == false) { return; }
+
+	FSwapTrajectoryPath& Path = Paths[PathIndex];
+	for (const FHitResult& Hit : Datum.OutHits)
+	{
+		if (Hit.bBlockingHit && (Path.FirstBlockedSegment == INDEX_NONE || Segment < Path.FirstBlockedSegment))
+		{
+			Path.FirstBlockedSegment = Segment;
+			Path.BlockLocation = Hit.Location;
+		}
+	}
+
+	if (--Path.PendingSweeps == 0)
+	{
+		PublishPath(PathIndex);
+	}
+}
+
+void USwapTrajectoryPreviewComponent::PublishPath(int32 PathIndex)
+{
+	FSwapTrajectoryPath& Path = Paths[PathIndex];
+
+	// The body stops where it first hits something
+	if (Path.FirstBlockedSegment != INDEX_NONE)
+	{
+		Path.Points.SetNum(Path.FirstBlockedSegment + 1);
+		Path.Points.Add(Path.BlockLocation);
+	}
+
+	OnTrajectoryPreview.Broadcast(Path.Body.Get(), Path.Points);
+}
@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Async/Future.h"
+#include "WorldCollision.h"
+#include "SwapTrajectoryPreviewComponent.generated.h"
+
+//--- forward declarations ---
+class UGravitySwapComponent;
+
+// Everything the worker thread needs to integrate one path. Copied, so no UObject is touched off the game thread
+struct FSwapTrajectoryInput
+{
+	FVector Location = FVector::ZeroVector;
+	FVector Velocity = FVector::ZeroVector;
+	FVector GravityPoint = FVector::ZeroVector;
+	float Acceleration = 0.f;
+	int32 NumSteps = 0;
+	float StepTime = 0.f;
+	int32 StepsPerPoint = 1;
+};
+
+struct FSwapTrajectoryPath
+{
+	TWeakObjectPtr<UGravitySwapComponent> Body;
+	TFuture<TArray<FVector>> Simulation;
+	TArray<FVector> Points;
+	float SweepRadius = 0.f;
+	int32 PendingSweeps = 0;
+	int32 FirstBlockedSegment = INDEX_NONE;
+	FVector BlockLocation = FVector::ZeroVector;
+	bool bSimulating = false;
+};
+
+/**
+ * Predicts where two swappable bodies will go if their gravity is swapped.
+ * Paths are integrated under radial gravity on a worker thread, checked against the world with async sweeps,
+ * and published as polylines for a spline or beam renderer.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class GP2_TEAM5_API USwapTrajectoryPreviewComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	USwapTrajectoryPreviewComponent();
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Starts predicting the post-flip paths of both bodies. Bodies that don't simulate physics are skipped
+	void StartPreview(UGravitySwapComponent* First, UGravitySwapComponent* Second);
+	void ClearPreview();
+
+	bool IsPreviewing(const UGravitySwapComponent* First, const UGravitySwapComponent* Second) const;
+
+	static TArray<FVector> SimulatePath(const FSwapTrajectoryInput& Input);
+
+public:
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnTrajectoryPreviewDelegate, UGravitySwapComponent*, Body, const TArray<FVector>&, Points);
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnTrajectoryPreviewClearedDelegate);
+
+	UPROPERTY(BlueprintAssignable, Category = "Gravity|Preview")
+	FOnTrajectoryPreviewDelegate OnTrajectoryPreview;
+
+	UPROPERTY(BlueprintAssignable, Category = "Gravity|Preview")
+	FOnTrajectoryPreviewClearedDelegate OnTrajectoryPreviewCleared;
+
+protected:
+	void StartPath(int32 PathIndex);
+	void IssueSweeps(int32 PathIndex);
+	void OnSweepCompleted(const FTraceHandle& Handle, FTraceDatum& Datum);
+	void PublishPath(int32 PathIndex);
+
+	UPROPERTY(EditAnywhere, Category = "Gravity|Preview", meta = (ClampMin = "1"))
+	int32 NumSteps = 60;
+
+	UPROPERTY(EditAnywhere, Category = "Gravity|Preview", meta = (ClampMin = "0.001"))
+	float StepTime = 1.f / 30.f;
+
+	/* Integration steps per polyline point. Each polyline segment costs one async sweep */
+	UPROPERTY(EditAnywhere, Category = "Gravity|Preview", meta = (ClampMin = "1"))
+	int32 StepsPerPoint = 3;
+
+	UPROPERTY(EditAnywhere, Category = "Gravity|Preview")
+	TEnumAsByte<ECollisionChannel> SweepChannel = ECC_Visibility;
+
+	TArray<FSwapTrajectoryPath, TInlineAllocator<2>> Paths;
+	FTraceDelegate SweepDelegate;
+
+	// Bumped on every preview so late sweep results of an old preview are ignored
+	uint8 Generation = 0;
+};